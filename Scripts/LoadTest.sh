@@ -0,0 +1,58 @@
+#!/usr/bin/env bash
+# Runs a dedicated server and ramps up headless bot clients against it over loopback, all on this machine.
+# The server writes its per connection report to Saved/LoadTest/ (see ULoadTestMonitorComponent).
+#
+# Usage: LoadTest.sh <server binary> <client binary> <map> <bot count> [seconds between bots] [seconds to run at full count]
+# e.g.   LoadTest.sh ./LinuxServer/SurvivalGameServer.sh ./LinuxNoEditor/SurvivalGame.sh /Game/Maps/Main 32 10 120
+# Set PACKED_MOVES=0 to have the bots use the engines movement RPCs instead of packed batches, to compare the two.
+# Set BOT_SEED to change what the bots do, the same seed and bot count plays out the same way each run.
+
+set -euo pipefail
+
+if [ $# -lt 4 ]; then
+	sed -n '2,8p' "$0"
+	exit 1
+fi
+
+SERVER="$1"
+CLIENT="$2"
+MAP="$3"
+BOTS="$4"
+RAMP_SECONDS="${5:-10}"
+HOLD_SECONDS="${6:-120}"
+PACKED_MOVES="${PACKED_MOVES:-1}"
+BOT_SEED="${BOT_SEED:-0}"
+PORT=7777
+LOG_DIR="LoadTestLogs/$(date +%Y%m%d-%H%M%S)"
+
+mkdir -p "$LOG_DIR"
+
+PIDS=()
+
+cleanup()
+{
+	for PID in "${PIDS[@]}"; do
+		kill "$PID" 2>/dev/null || true
+	done
+	wait 2>/dev/null || true
+}
+trap cleanup EXIT INT TERM
+
+# MaxPlayers has to cover every bot, or the game session turns them away
+"$SERVER" "$MAP?MaxPlayers=$((BOTS + 1))" -port=$PORT -SurvivalLoadTest -log -unattended > "$LOG_DIR/Server.log" 2>&1 &
+PIDS+=($!)
+
+echo "Server started, logs in $LOG_DIR"
+sleep "$RAMP_SECONDS"
+
+# one bot at a time, so the report shows the cost of each step up in player count
+for ((i = 1; i <= BOTS; i++)); do
+	"$CLIENT" 127.0.0.1:$PORT -SurvivalBot -SurvivalBotSeed=$BOT_SEED -SurvivalBotIndex=$i -ExecCmds="Survival.PackedMoves $PACKED_MOVES" -nullrhi -nosound -unattended -log > "$LOG_DIR/Bot$i.log" 2>&1 &
+	PIDS+=($!)
+
+	echo "Bot $i/$BOTS connected"
+	sleep "$RAMP_SECONDS"
+done
+
+echo "All $BOTS bots running, holding for $HOLD_SECONDS seconds"
+sleep "$HOLD_SECONDS"
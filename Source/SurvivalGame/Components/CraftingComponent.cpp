@@ -0,0 +1,343 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CraftingComponent.h"
+#include "SurvivalGame.h"
+#include "Items/Item.h"
+#include "Items/CraftingRecipe.h"
+#include "Components/InventoryComponent.h"
+#include "Components/LoadTestMonitorComponent.h"
+#include "World/Pickup.h"
+#include "Engine/DataTable.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+
+UCraftingComponent::UCraftingComponent()
+{
+	//everything here is driven by inventory changes and timers
+	PrimaryComponentTick.bCanEverTick = false;
+
+	SetIsReplicated(true);
+
+	RecipeTable = nullptr;
+	MaxQueueSize = 20;
+	bAvailabilityFlushPending = false;
+}
+
+void UCraftingComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!GetOwner()->HasAuthority())
+	{
+		return;
+	}
+
+	Inventory = GetOwner()->FindComponentByClass<UInventoryComponent>();
+
+	BuildRecipeIndex();
+
+	if (Inventory)
+	{
+		Inventory->OnItemQuantityChanged.AddDynamic(this, &UCraftingComponent::OnItemQuantityChanged);
+
+		//count anything the inventory started with
+		for (UItem* Item : Inventory->GetItems())
+		{
+			OnItemQuantityChanged(Item, Item ? Item->GetQuantity() : 0);
+		}
+	}
+}
+
+void UCraftingComponent::BuildRecipeIndex()
+{
+	if (!RecipeTable)
+	{
+		return;
+	}
+
+	static const FString ContextString(TEXT("CraftingComponent"));
+
+	for (const FName& RowName : RecipeTable->GetRowNames())
+	{
+		const FCraftingRecipe* Recipe = RecipeTable->FindRow<FCraftingRecipe>(RowName, ContextString);
+
+		if (!Recipe || !Recipe->Result)
+		{
+			continue;
+		}
+
+		const int32 RecipeIndex = Recipes.Add(Recipe);
+		RecipeNames.Add(RowName);
+		RecipeIndices.Add(RowName, RecipeIndex);
+
+		//the same item listed twice in a recipe is just one ingredient needing more of it
+		TMap<UClass*, int32> Required;
+		for (const FCraftingIngredient& Ingredient : Recipe->Ingredients)
+		{
+			if (Ingredient.Item)
+			{
+				Required.FindOrAdd(Ingredient.Item) += Ingredient.Quantity;
+			}
+		}
+
+		for (const TPair<UClass*, int32>& Ingredient : Required)
+		{
+			RecipesByIngredient.FindOrAdd(Ingredient.Key).Add(TPair<int32, int32>(RecipeIndex, Ingredient.Value));
+		}
+
+		//the inventory hasn't been counted yet, so every ingredient starts out missing
+		MissingIngredients.Add(Required.Num());
+
+		//recipes that need nothing are craftable straight away, so the client needs to hear about them
+		if (Required.Num() == 0)
+		{
+			ChangedRecipes.Add(RecipeIndex);
+		}
+	}
+
+	NotifiedCraftable.Init(false, Recipes.Num());
+
+	if (ChangedRecipes.Num() > 0)
+	{
+		bAvailabilityFlushPending = true;
+		GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UCraftingComponent::FlushAvailabilityChanges);
+	}
+}
+
+void UCraftingComponent::OnItemQuantityChanged(class UItem* Item, int32 QuantityDelta)
+{
+	if (!Item || QuantityDelta == 0)
+	{
+		return;
+	}
+
+	UClass* ItemClass = Item->GetClass();
+
+	int32& Count = ItemCounts.FindOrAdd(ItemClass);
+	const int32 OldCount = Count;
+	Count += QuantityDelta;
+	const int32 NewCount = Count;
+
+	//only the recipes that use this item can have changed, and only if we crossed the amount they need
+	if (const TArray<TPair<int32, int32>>* Uses = RecipesByIngredient.Find(ItemClass))
+	{
+		for (const TPair<int32, int32>& Use : *Uses)
+		{
+			const bool bHadEnough = OldCount >= Use.Value;
+			const bool bHasEnough = NewCount >= Use.Value;
+
+			if (bHadEnough != bHasEnough)
+			{
+				MissingIngredients[Use.Key] += bHasEnough ? -1 : 1;
+				ChangedRecipes.Add(Use.Key);
+			}
+		}
+	}
+
+	//a stack being split up or topped up fires lots of these in one frame, so the client gets them all together next tick
+	if (ChangedRecipes.Num() > 0 && !bAvailabilityFlushPending)
+	{
+		bAvailabilityFlushPending = true;
+		GetWorld()->GetTimerManager().SetTimerForNextTick(this, &UCraftingComponent::FlushAvailabilityChanges);
+	}
+}
+
+void UCraftingComponent::FlushAvailabilityChanges()
+{
+	bAvailabilityFlushPending = false;
+
+	TArray<FName> NowCraftable;
+	TArray<FName> NowUncraftable;
+
+	//a recipe can flip back and forth before we get here, only send it if it ended up different to what the client has
+	for (const int32 RecipeIndex : ChangedRecipes)
+	{
+		const bool bCraftable = IsRecipeIndexCraftable(RecipeIndex);
+
+		if (bCraftable != NotifiedCraftable[RecipeIndex])
+		{
+			NotifiedCraftable[RecipeIndex] = bCraftable;
+			(bCraftable ? NowCraftable : NowUncraftable).Add(RecipeNames[RecipeIndex]);
+		}
+	}
+
+	ChangedRecipes.Reset();
+
+	if (NowCraftable.Num() > 0 || NowUncraftable.Num() > 0)
+	{
+		ClientRecipeAvailabilityChanged(NowCraftable, NowUncraftable);
+	}
+}
+
+void UCraftingComponent::ClientRecipeAvailabilityChanged_Implementation(const TArray<FName>& NowCraftable, const TArray<FName>& NowUncraftable)
+{
+	for (const FName& RecipeName : NowCraftable)
+	{
+		CraftableRecipes.Add(RecipeName);
+		OnRecipeAvailabilityChanged.Broadcast(RecipeName, true);
+	}
+
+	for (const FName& RecipeName : NowUncraftable)
+	{
+		CraftableRecipes.Remove(RecipeName);
+		OnRecipeAvailabilityChanged.Broadcast(RecipeName, false);
+	}
+}
+
+bool UCraftingComponent::IsRecipeCraftable(const FName RecipeName) const
+{
+	return CraftableRecipes.Contains(RecipeName);
+}
+
+void UCraftingComponent::Craft(const FName RecipeName, const int32 Count /*= 1*/)
+{
+	if (!GetOwner()->HasAuthority())
+	{
+		ServerCraft(RecipeName, Count);
+		return;
+	}
+
+	const int32* RecipeIndex = RecipeIndices.Find(RecipeName);
+
+	//ingredients are checked again when the craft completes, this just stops people queueing things they can't make
+	if (!RecipeIndex || !IsRecipeIndexCraftable(*RecipeIndex))
+	{
+		return;
+	}
+
+	const FCraftingRecipe* Recipe = Recipes[*RecipeIndex];
+	const int32 NumToQueue = FMath::Min(Count, MaxQueueSize - CraftQueue.Num());
+
+	//crafts happen one after another, so each one completes CraftTime after the one before it
+	float CompleteTime = CraftQueue.Num() > 0 ? CraftQueue.Last().CompleteTime : GetWorld()->GetTimeSeconds();
+
+	for (int32 i = 0; i < NumToQueue; ++i)
+	{
+		CompleteTime += Recipe->CraftTime;
+
+		FCraftingJob Job;
+		Job.RecipeIndex = *RecipeIndex;
+		Job.CompleteTime = CompleteTime;
+		CraftQueue.Add(Job);
+	}
+
+	if (!GetWorld()->GetTimerManager().IsTimerActive(TimerHandle_CraftQueue))
+	{
+		ScheduleCraftQueue();
+	}
+}
+
+void UCraftingComponent::ServerCraft_Implementation(const FName RecipeName, const int32 Count)
+{
+	ULoadTestMonitorComponent::RecordServerRPC(GetOwner());
+	Craft(RecipeName, Count);
+}
+
+bool UCraftingComponent::ServerCraft_Validate(const FName RecipeName, const int32 Count)
+{
+	return Count > 0;
+}
+
+void UCraftingComponent::ScheduleCraftQueue()
+{
+	if (CraftQueue.Num() > 0)
+	{
+		//a zero rate would clear the timer instead of firing it next frame
+		const float Delay = FMath::Max(CraftQueue[0].CompleteTime - GetWorld()->GetTimeSeconds(), KINDA_SMALL_NUMBER);
+		GetWorld()->GetTimerManager().SetTimer(TimerHandle_CraftQueue, this, &UCraftingComponent::ProcessCraftQueue, Delay, false);
+	}
+}
+
+void UCraftingComponent::ProcessCraftQueue()
+{
+	if (CraftQueue.Num() == 0)
+	{
+		return;
+	}
+
+	//the timer only fires once the front craft is due, and quick recipes can have several more due by the same frame
+	const float CurrentTime = GetWorld()->GetTimeSeconds();
+	int32 NumDue = 1;
+
+	while (NumDue < CraftQueue.Num() && CraftQueue[NumDue].CompleteTime <= CurrentTime)
+	{
+		++NumDue;
+	}
+
+	bool bCraftedAnything = false;
+
+	for (int32 i = 0; i < NumDue; ++i)
+	{
+		bCraftedAnything |= CompleteCraft(CraftQueue[i].RecipeIndex);
+	}
+
+	CraftQueue.RemoveAt(0, NumDue, false);
+
+	//the whole batch goes out in one net update, and the client hears about availability once for it
+	if (bCraftedAnything)
+	{
+		GetOwner()->ForceNetUpdate();
+	}
+
+	FlushAvailabilityChanges();
+
+	ScheduleCraftQueue();
+}
+
+bool UCraftingComponent::CompleteCraft(const int32 RecipeIndex)
+{
+	if (!Inventory || !IsRecipeIndexCraftable(RecipeIndex))
+	{
+		return false;
+	}
+
+	const FCraftingRecipe* Recipe = Recipes[RecipeIndex];
+
+	//ingredients can be spread over several stacks, keep taking from them until we've used up enough
+	for (const FCraftingIngredient& Ingredient : Recipe->Ingredients)
+	{
+		int32 Remaining = Ingredient.Quantity;
+
+		while (Remaining > 0)
+		{
+			UItem* Item = Inventory->FindItemByClass(Ingredient.Item);
+			const int32 Consumed = Item ? Inventory->ConsumeItem(Item, Remaining) : 0;
+
+			if (Consumed <= 0)
+			{
+				break;
+			}
+
+			Remaining -= Consumed;
+		}
+	}
+
+	//an item can't hold more than a stack, so a recipe making more than that is added, and dropped, a stack at a time
+	const UItem* ResultDefaults = Recipe->Result ? Recipe->Result->GetDefaultObject<UItem>() : nullptr;
+	const int32 StackSize = ResultDefaults && ResultDefaults->bStackable ? FMath::Max(ResultDefaults->MaxStackSize, 1) : 1;
+
+	for (int32 Remaining = ResultDefaults ? Recipe->ResultQuantity : 0; Remaining > 0; Remaining -= StackSize)
+	{
+		const int32 StackQuantity = FMath::Min(Remaining, StackSize);
+		const FItemAddResult AddResult = Inventory->TryAddItemFromClass(Recipe->Result, StackQuantity);
+		const int32 AmountLeftOver = StackQuantity - AddResult.ActualAmountGiven;
+
+		//the ingredients are gone, so don't lose what they made just because the inventory was full
+		if (AmountLeftOver > 0 && DropPickupClass)
+		{
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.Owner = GetOwner();
+			SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+			SURVIVAL_LLM_SCOPE(Pickups);
+
+			if (APickup* Pickup = GetWorld()->SpawnActor<APickup>(DropPickupClass, GetOwner()->GetActorTransform(), SpawnParams))
+			{
+				Pickup->InitializePickup(Recipe->Result, AmountLeftOver);
+			}
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "CraftingComponent.generated.h"
+
+//Called on the owning client when a recipe becomes craftable or stops being craftable
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnRecipeAvailabilityChanged, FName, RecipeName, bool, bCraftable);
+
+/**
+ * Crafting on top of the owners inventory. The server keeps a count of every item class in the inventory and an index from each
+ * ingredient to the recipes that use it, so a quantity change only re-checks the recipes using that item, not every recipe.
+ * Availability changes are collected and sent to the owning client as one delta per frame.
+ * Queued crafts complete on the server in batches, with one net update per batch.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class SURVIVALGAME_API UCraftingComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UCraftingComponent();
+
+	//Data table of FCraftingRecipe
+	UPROPERTY(EditDefaultsOnly, Category = "Crafting")
+	class UDataTable* RecipeTable;
+
+	//If the inventory can't fit everything a craft makes, the rest is dropped as one of these
+	UPROPERTY(EditDefaultsOnly, Category = "Crafting")
+	TSubclassOf<class APickup> DropPickupClass;
+
+	//The most crafts that can be queued up at once
+	UPROPERTY(EditDefaultsOnly, Category = "Crafting", meta = (ClampMin = 1))
+	int32 MaxQueueSize;
+
+	//Queue up Count crafts of a recipe. Can be called on the client
+	UFUNCTION(BlueprintCallable, Category = "Crafting")
+	void Craft(const FName RecipeName, const int32 Count = 1);
+
+	//Whether we have the ingredients for a recipe. On the client this is as of the last delta from the server
+	UFUNCTION(BlueprintPure, Category = "Crafting")
+	bool IsRecipeCraftable(const FName RecipeName) const;
+
+	UPROPERTY(BlueprintAssignable, Category = "Crafting")
+	FOnRecipeAvailabilityChanged OnRecipeAvailabilityChanged;
+
+protected:
+
+	virtual void BeginPlay() override;
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerCraft(const FName RecipeName, const int32 Count);
+
+	//Sends a batch of availability changes down to the owning client
+	UFUNCTION(Client, Reliable)
+	void ClientRecipeAvailabilityChanged(const TArray<FName>& NowCraftable, const TArray<FName>& NowUncraftable);
+
+	//[Server] Keeps the item counts and recipe availability up to date as the inventory changes
+	UFUNCTION()
+	void OnItemQuantityChanged(class UItem* Item, int32 QuantityDelta);
+
+	//[Server] Build the ingredient to recipe index from the recipe table
+	void BuildRecipeIndex();
+
+	//[Server] Send any availability changes collected this frame
+	void FlushAvailabilityChanges();
+
+	//[Server] Complete every queued craft that's due, then schedule the next batch
+	void ProcessCraftQueue();
+
+	//[Server] Set the timer for when the craft at the front of the queue is due
+	void ScheduleCraftQueue();
+
+	//[Server] Use up the ingredients and add the result for one craft. False if we no longer have the ingredients
+	bool CompleteCraft(const int32 RecipeIndex);
+
+	FORCEINLINE bool IsRecipeIndexCraftable(const int32 RecipeIndex) const { return MissingIngredients[RecipeIndex] == 0; }
+
+	UPROPERTY()
+	class UInventoryComponent* Inventory;
+
+	//Recipe rows, and for each one how many of its ingredients we don't have enough of
+	TArray<FName> RecipeNames;
+	TMap<FName, int32> RecipeIndices;
+	TArray<const struct FCraftingRecipe*> Recipes;
+	TArray<int32> MissingIngredients;
+
+	//For each ingredient class, the recipes using it and how many of it they need
+	TMap<UClass*, TArray<TPair<int32, int32>>> RecipesByIngredient;
+
+	//How many of each item class the inventory holds, across all of its stacks
+	TMap<UClass*, int32> ItemCounts;
+
+	//Recipes whose availability changed since the last flush, and what the client was last told
+	TArray<int32> ChangedRecipes;
+	TBitArray<> NotifiedCraftable;
+	bool bAvailabilityFlushPending;
+
+	//What the client knows is craftable
+	TSet<FName> CraftableRecipes;
+
+	struct FCraftingJob
+	{
+		int32 RecipeIndex;
+		float CompleteTime;
+	};
+
+	//Queued crafts in the order they'll complete
+	TArray<FCraftingJob> CraftQueue;
+
+	FTimerHandle TimerHandle_CraftQueue;
+
+};
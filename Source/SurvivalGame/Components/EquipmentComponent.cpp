@@ -0,0 +1,193 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EquipmentComponent.h"
+#include "Items/EquippableItem.h"
+#include "Components/GearMeshMergeComponent.h"
+#include "Engine/AssetManager.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Net/UnrealNetwork.h"
+
+UEquipmentComponent::UEquipmentComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	SetIsReplicated(true);
+
+	HighPriorityLoadDistance = 1000.f;
+	LowPriorityLoadDistance = 10000.f;
+
+	EquippedItemIds.SetNumZeroed(NumSlots);
+}
+
+void UEquipmentComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	LoadedItemIds.SetNumZeroed(NumSlots);
+	LoadHandles.SetNum(NumSlots);
+
+	//a character coming into relevancy already has its gear replicated by now, and won't get a rep notify for it
+	OnRep_EquippedItemIds();
+}
+
+void UEquipmentComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	for (TSharedPtr<FStreamableHandle>& Handle : LoadHandles)
+	{
+		if (Handle.IsValid())
+		{
+			Handle->CancelHandle();
+			Handle.Reset();
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UEquipmentComponent::GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(UEquipmentComponent, EquippedItemIds);
+}
+
+bool UEquipmentComponent::EquipItem(TSubclassOf<class UEquippableItem> ItemClass)
+{
+	if (!GetOwner()->HasAuthority() || !ItemClass)
+	{
+		return false;
+	}
+
+	const int32 ItemIndex = EquippableItems.IndexOfByKey(ItemClass);
+
+	if (ItemIndex == INDEX_NONE)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Tried to equip %s but it isn't in EquippableItems."), *ItemClass->GetName());
+		return false;
+	}
+
+	EquippedItemIds[(int32)ItemClass->GetDefaultObject<UEquippableItem>()->Slot] = (uint16)(ItemIndex + 1);
+
+	//server doesnt get rep notifies, so call it ourselves
+	OnRep_EquippedItemIds();
+
+	return true;
+}
+
+void UEquipmentComponent::UnequipSlot(EEquippableSlot Slot)
+{
+	if (GetOwner()->HasAuthority())
+	{
+		EquippedItemIds[(int32)Slot] = 0;
+		OnRep_EquippedItemIds();
+	}
+}
+
+TSubclassOf<class UEquippableItem> UEquipmentComponent::GetEquippedItem(EEquippableSlot Slot) const
+{
+	return EquippedItemIds.IsValidIndex((int32)Slot) ? GetItemFromId(EquippedItemIds[(int32)Slot]) : nullptr;
+}
+
+TSubclassOf<class UEquippableItem> UEquipmentComponent::GetItemFromId(const uint16 ItemId) const
+{
+	return EquippableItems.IsValidIndex(ItemId - 1) ? EquippableItems[ItemId - 1] : nullptr;
+}
+
+void UEquipmentComponent::OnRep_EquippedItemIds()
+{
+	//gear is only cosmetic, the dedicated server doesn't need the meshes
+	if (!HasBegunPlay() || GetNetMode() == NM_DedicatedServer)
+	{
+		return;
+	}
+
+	//worked out once for every slot that changed in this update
+	int32 Priority = INDEX_NONE;
+
+	for (int32 SlotIndex = 0; SlotIndex < NumSlots && SlotIndex < EquippedItemIds.Num(); ++SlotIndex)
+	{
+		if (EquippedItemIds[SlotIndex] != LoadedItemIds[SlotIndex])
+		{
+			if (Priority == INDEX_NONE)
+			{
+				Priority = GetLoadPriority();
+			}
+
+			LoadSlot(SlotIndex, Priority);
+		}
+	}
+}
+
+void UEquipmentComponent::LoadSlot(const int32 SlotIndex, const int32 Priority)
+{
+	const uint16 ItemId = EquippedItemIds[SlotIndex];
+	LoadedItemIds[SlotIndex] = ItemId;
+
+	//whatever the slot was loading before isn't wanted anymore
+	if (LoadHandles[SlotIndex].IsValid())
+	{
+		LoadHandles[SlotIndex]->CancelHandle();
+		LoadHandles[SlotIndex].Reset();
+	}
+
+	const UEquippableItem* Item = GetItemFromId(ItemId) ? GetItemFromId(ItemId)->GetDefaultObject<UEquippableItem>() : nullptr;
+
+	//already in memory, or nothing to load, so there's nothing to wait for
+	if (!Item || Item->Mesh.IsNull() || Item->Mesh.Get())
+	{
+		OnSlotLoaded(SlotIndex, ItemId);
+		return;
+	}
+
+	FStreamableManager& StreamableManager = UAssetManager::GetStreamableManager();
+	LoadHandles[SlotIndex] = StreamableManager.RequestAsyncLoad(Item->Mesh.ToSoftObjectPath(), FStreamableDelegate::CreateUObject(this, &UEquipmentComponent::OnSlotLoaded, SlotIndex, ItemId), Priority);
+}
+
+void UEquipmentComponent::OnSlotLoaded(const int32 SlotIndex, const uint16 ItemId)
+{
+	//the slot changed again while we were loading, the newer load will put its own mesh on
+	if (LoadedItemIds[SlotIndex] != ItemId)
+	{
+		return;
+	}
+
+	ASurvivalCharacter* Character = Cast<ASurvivalCharacter>(GetOwner());
+
+	if (!Character || !Character->GearMeshMerge)
+	{
+		return;
+	}
+
+	const TSubclassOf<UEquippableItem> ItemClass = GetItemFromId(ItemId);
+	const UEquippableItem* Item = ItemClass ? ItemClass->GetDefaultObject<UEquippableItem>() : nullptr;
+
+	//the merge component keeps a reference to the mesh, so the handle can let go of it
+	Character->GearMeshMerge->SetGearMesh((EEquippableSlot)SlotIndex, Item ? Item->Mesh.Get() : nullptr, Item ? Item->AnimateInTime : 0.f);
+
+	LoadHandles[SlotIndex].Reset();
+}
+
+int32 UEquipmentComponent::GetLoadPriority() const
+{
+	APlayerController* PC = GetWorld()->GetFirstPlayerController();
+	const APawn* OwnerPawn = Cast<APawn>(GetOwner());
+
+	//our own gear is always the most important
+	if (!PC || (OwnerPawn && OwnerPawn->IsLocallyControlled()))
+	{
+		return FStreamableManager::AsyncLoadHighPriority;
+	}
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	const float Distance = FVector::Dist(ViewLocation, GetOwner()->GetActorLocation());
+	const float Alpha = FMath::GetRangePct(HighPriorityLoadDistance, FMath::Max(LowPriorityLoadDistance, HighPriorityLoadDistance + 1.f), Distance);
+
+	return FMath::RoundToInt(FMath::Lerp((float)FStreamableManager::AsyncLoadHighPriority, (float)FStreamableManager::DefaultAsyncLoadPriority, FMath::Clamp(Alpha, 0.f, 1.f)));
+}
@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Engine/StreamableManager.h"
+#include "Player/SurvivalCharacter.h"
+#include "EquipmentComponent.generated.h"
+
+/**
+ * Tracks which equippable item is in each gear slot and gets the gear meshes onto the character without hitching.
+ * The server replicates the equipped set as one small array of item ids, an index into EquippableItems per slot.
+ * Clients stream the gear meshes in asynchronously and only swap a mesh in once it has loaded. Nearby characters load first,
+ * so a crowd coming into relevancy dresses from the closest one out. The dedicated server never loads gear meshes at all.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class SURVIVALGAME_API UEquipmentComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UEquipmentComponent();
+
+	//Every item that can be equipped. An items id is its position in this list plus one, so this must be the same on the server and clients
+	UPROPERTY(EditDefaultsOnly, Category = "Equipment")
+	TArray<TSubclassOf<class UEquippableItem>> EquippableItems;
+
+	//Characters closer than this load their gear at the highest priority
+	UPROPERTY(EditDefaultsOnly, Category = "Equipment", meta = (ClampMin = 0.0))
+	float HighPriorityLoadDistance;
+
+	//Characters further than this load their gear at the lowest priority
+	UPROPERTY(EditDefaultsOnly, Category = "Equipment", meta = (ClampMin = 0.0))
+	float LowPriorityLoadDistance;
+
+	//[Server] Put an item in its slot, replacing whatever was there. Returns false if the item isn't in EquippableItems
+	UFUNCTION(BlueprintCallable, Category = "Equipment")
+	bool EquipItem(TSubclassOf<class UEquippableItem> ItemClass);
+
+	//[Server] Take off whatever is in the slot
+	UFUNCTION(BlueprintCallable, Category = "Equipment")
+	void UnequipSlot(EEquippableSlot Slot);
+
+	UFUNCTION(BlueprintPure, Category = "Equipment")
+	TSubclassOf<class UEquippableItem> GetEquippedItem(EEquippableSlot Slot) const;
+
+	static const int32 NumSlots = (int32)EEquippableSlot::EIS_Backpack + 1;
+
+protected:
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
+
+	TSubclassOf<class UEquippableItem> GetItemFromId(const uint16 ItemId) const;
+
+	//The id of the item equipped in each slot, zero for nothing
+	UPROPERTY(ReplicatedUsing = OnRep_EquippedItemIds)
+	TArray<uint16> EquippedItemIds;
+
+	UFUNCTION()
+	void OnRep_EquippedItemIds();
+
+	//Start loading the gear mesh for whatever is now in the slot, and show it once it's in
+	void LoadSlot(const int32 SlotIndex, const int32 Priority);
+
+	void OnSlotLoaded(const int32 SlotIndex, const uint16 ItemId);
+
+	//Closer characters get a higher async load priority
+	int32 GetLoadPriority() const;
+
+	//The item id each slot is showing or loading, so we only touch slots that actually changed
+	TArray<uint16> LoadedItemIds;
+
+	//In flight mesh loads, one per slot
+	TArray<TSharedPtr<FStreamableHandle>> LoadHandles;
+
+};
@@ -0,0 +1,222 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GearMeshMergeComponent.h"
+#include "Framework/GearMeshMergeSubsystem.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+#include "TimerManager.h"
+
+UGearMeshMergeComponent::UGearMeshMergeComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	bMergeGearMeshes = true;
+	bMergeQueued = false;
+}
+
+void UGearMeshMergeComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (ASurvivalCharacter* Character = GetCharacter())
+	{
+		BaseBodyMesh = Character->GetMesh()->SkeletalMesh;
+
+		//pick up any gear that was assigned to the components in the editor
+		for (auto& PlayerMesh : Character->PlayerMeshes)
+		{
+			if (PlayerMesh.Value && PlayerMesh.Value->SkeletalMesh)
+			{
+				GearMeshes.Add(PlayerMesh.Key, PlayerMesh.Value->SkeletalMesh);
+			}
+		}
+	}
+
+	RefreshGearMeshes();
+}
+
+void UGearMeshMergeComponent::SetGearMesh(EEquippableSlot Slot, USkeletalMesh* Mesh, float AnimateInTime /*= 0.f*/)
+{
+	if (Mesh)
+	{
+		GearMeshes.Add(Slot, Mesh);
+	}
+	else
+	{
+		GearMeshes.Remove(Slot);
+	}
+
+	//draw the gear separately while the new piece animates in, we'll merge again once it's done
+	if (AnimateInTime > 0.f && Mesh)
+	{
+		GetOwner()->GetWorldTimerManager().SetTimer(TimerHandle_AnimateIn, this, &UGearMeshMergeComponent::FinishAnimatingIn, AnimateInTime, false);
+	}
+
+	RefreshGearMeshes();
+}
+
+USkeletalMesh* UGearMeshMergeComponent::GetGearMesh(EEquippableSlot Slot) const
+{
+	return GearMeshes.FindRef(Slot);
+}
+
+bool UGearMeshMergeComponent::IsMerged() const
+{
+	return MergedMesh != nullptr;
+}
+
+void UGearMeshMergeComponent::RefreshGearMeshes()
+{
+	//possession can happen before BeginPlay has picked up the editor assigned gear
+	if (!HasBegunPlay() || !GetCharacter())
+	{
+		return;
+	}
+
+#if !UE_SERVER
+	UGearMeshMergeSubsystem* MergeSubsystem = UGearMeshMergeSubsystem::Get(this);
+
+	if (MergeSubsystem && ShouldMerge())
+	{
+		TArray<USkeletalMesh*> SourceMeshes;
+		GetMergeSourceMeshes(SourceMeshes);
+
+		if (USkeletalMesh* CachedMesh = MergeSubsystem->FindMergedMesh(SourceMeshes))
+		{
+			ApplyMergedMesh(CachedMesh);
+			return;
+		}
+
+		//merging hitches, so wait our turn rather than merging in the middle of e.g. a crowd coming into relevancy
+		if (!bMergeQueued)
+		{
+			bMergeQueued = true;
+			MergeSubsystem->QueueMerge(this);
+		}
+	}
+#endif
+
+	ApplySeparateMeshes();
+}
+
+bool UGearMeshMergeComponent::MergeQueuedGear()
+{
+	bMergeQueued = false;
+
+	UGearMeshMergeSubsystem* MergeSubsystem = UGearMeshMergeSubsystem::Get(this);
+
+	//the gear or owner may have changed while we were queued
+	if (!MergeSubsystem || !HasBegunPlay() || !GetCharacter() || !ShouldMerge())
+	{
+		return false;
+	}
+
+	TArray<USkeletalMesh*> SourceMeshes;
+	GetMergeSourceMeshes(SourceMeshes);
+
+	//someone wearing the same thing got there first
+	if (USkeletalMesh* CachedMesh = MergeSubsystem->FindMergedMesh(SourceMeshes))
+	{
+		ApplyMergedMesh(CachedMesh);
+		return false;
+	}
+
+	if (USkeletalMesh* NewMergedMesh = MergeSubsystem->CreateMergedMesh(SourceMeshes, GetOwner()))
+	{
+		ApplyMergedMesh(NewMergedMesh);
+	}
+
+	return true;
+}
+
+bool UGearMeshMergeComponent::ShouldMerge() const
+{
+	const ASurvivalCharacter* Character = GetCharacter();
+
+	//server never draws anything, and the local player sees their gear through the separate components since the body is owner no see
+	if (!bMergeGearMeshes || !BaseBodyMesh || GearMeshes.Num() == 0 || GetNetMode() == NM_DedicatedServer || Character->IsLocallyControlled())
+	{
+		return false;
+	}
+
+	return !GetOwner()->GetWorldTimerManager().IsTimerActive(TimerHandle_AnimateIn);
+}
+
+void UGearMeshMergeComponent::GetMergeSourceMeshes(TArray<USkeletalMesh*>& OutMeshes) const
+{
+	TArray<EEquippableSlot> Slots;
+	GearMeshes.GenerateKeyArray(Slots);
+	Slots.Sort();
+
+	OutMeshes.Reset();
+	OutMeshes.Add(BaseBodyMesh);
+
+	for (const EEquippableSlot Slot : Slots)
+	{
+		OutMeshes.Add(GearMeshes.FindRef(Slot));
+	}
+}
+
+void UGearMeshMergeComponent::ApplyMergedMesh(USkeletalMesh* NewMergedMesh)
+{
+	ASurvivalCharacter* Character = GetCharacter();
+
+	if (MergedMesh != NewMergedMesh)
+	{
+		//keep the anim instance running, the merged mesh uses the same skeleton
+		Character->GetMesh()->SetSkeletalMesh(NewMergedMesh, false);
+		MergedMesh = NewMergedMesh;
+	}
+
+	//the gear is part of the body now, so the separate components don't need to draw, tick or update bounds
+	for (auto& PlayerMesh : Character->PlayerMeshes)
+	{
+		if (USkeletalMeshComponent* GearComponent = PlayerMesh.Value)
+		{
+			GearComponent->SetSkeletalMesh(nullptr);
+			GearComponent->SetVisibility(false);
+			GearComponent->SetComponentTickEnabled(false);
+		}
+	}
+}
+
+void UGearMeshMergeComponent::ApplySeparateMeshes()
+{
+	ASurvivalCharacter* Character = GetCharacter();
+
+	if (MergedMesh)
+	{
+		Character->GetMesh()->SetSkeletalMesh(BaseBodyMesh, false);
+		MergedMesh = nullptr;
+	}
+
+	//gear is cosmetic, the dedicated server turned its ticking off in SetupServerAnimation and it has to stay off
+	const bool bCanTickGear = GetNetMode() != NM_DedicatedServer;
+
+	for (auto& PlayerMesh : Character->PlayerMeshes)
+	{
+		if (USkeletalMeshComponent* GearComponent = PlayerMesh.Value)
+		{
+			USkeletalMesh* GearMesh = GearMeshes.FindRef(PlayerMesh.Key);
+
+			if (GearComponent->SkeletalMesh != GearMesh)
+			{
+				GearComponent->SetSkeletalMesh(GearMesh);
+			}
+
+			GearComponent->SetVisibility(GearMesh != nullptr);
+			GearComponent->SetComponentTickEnabled(bCanTickGear && GearMesh != nullptr);
+		}
+	}
+}
+
+void UGearMeshMergeComponent::FinishAnimatingIn()
+{
+	RefreshGearMeshes();
+}
+
+ASurvivalCharacter* UGearMeshMergeComponent::GetCharacter() const
+{
+	return Cast<ASurvivalCharacter>(GetOwner());
+}
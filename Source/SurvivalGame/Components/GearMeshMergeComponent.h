@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Player/SurvivalCharacter.h"
+#include "GearMeshMergeComponent.generated.h"
+
+/**
+ * Owns the gear meshes a character is wearing and decides how they are drawn. On remote characters the body and all
+ * equipped gear are baked into a single skeletal mesh, so a crowd costs one component per character instead of eight.
+ * Merged meshes are cached by the combination of pieces, so characters wearing the same outfit share one mesh. A combination that
+ * isn't cached yet waits its turn in the merge subsystem's queue, and the gear is drawn separately until then.
+ * The local player, the dedicated server and any piece that is still animating in use the separate gear components.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class SURVIVALGAME_API UGearMeshMergeComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UGearMeshMergeComponent();
+
+	//Whether to bake equipped gear into a single mesh. Gear meshes need Allow CPU Access enabled to be merged in a cooked build
+	UPROPERTY(EditDefaultsOnly, Category = "Mesh Merge")
+	bool bMergeGearMeshes;
+
+	//Put a mesh in a gear slot, or clear it with nullptr. If AnimateInTime is above zero, the gear is drawn with separate components
+	//for that long so the new piece can animate in, then it gets merged
+	UFUNCTION(BlueprintCallable, Category = "Mesh Merge")
+	void SetGearMesh(EEquippableSlot Slot, class USkeletalMesh* Mesh, float AnimateInTime = 0.f);
+
+	UFUNCTION(BlueprintPure, Category = "Mesh Merge")
+	class USkeletalMesh* GetGearMesh(EEquippableSlot Slot) const;
+
+	//True if the gear is currently drawn as part of the body mesh
+	UFUNCTION(BlueprintPure, Category = "Mesh Merge")
+	bool IsMerged() const;
+
+	//Rebuild the merged mesh, or go back to separate components, for the current gear and owner. Call this when the owner's controller changes
+	void RefreshGearMeshes();
+
+	//[Called by the merge subsystem] Our turn to merge. Returns true if we actually had to merge, false if there was nothing to do
+	bool MergeQueuedGear();
+
+protected:
+
+	virtual void BeginPlay() override;
+
+	bool ShouldMerge() const;
+
+	//The body followed by the gear in slot order, what gets merged and what the merged mesh is cached by
+	void GetMergeSourceMeshes(TArray<class USkeletalMesh*>& OutMeshes) const;
+
+	void ApplyMergedMesh(class USkeletalMesh* NewMergedMesh);
+	void ApplySeparateMeshes();
+
+	void FinishAnimatingIn();
+
+	class ASurvivalCharacter* GetCharacter() const;
+
+	//The mesh in each gear slot. This is the source of truth, the gear components only hold these while we aren't merged
+	UPROPERTY()
+	TMap<EEquippableSlot, class USkeletalMesh*> GearMeshes;
+
+	//The characters body mesh without any gear baked in
+	UPROPERTY()
+	class USkeletalMesh* BaseBodyMesh;
+
+	//The merged mesh the body is currently using, null if we're using separate components
+	UPROPERTY()
+	class USkeletalMesh* MergedMesh;
+
+	FTimerHandle TimerHandle_AnimateIn;
+
+	//Whether we're waiting in the merge subsystem's queue
+	bool bMergeQueued;
+
+};
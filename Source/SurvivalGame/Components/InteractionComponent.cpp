@@ -2,18 +2,22 @@
 
 
 #include "InteractionComponent.h"
+#include "SurvivalGame.h"
+#include "Framework/SurvivalMemoryReport.h"
 #include "Widgets/InteractionWidget.h"
 #include "Player/SurvivalCharacter.h"
 
 UInteractionComponent::UInteractionComponent()
 {
-	SetComponentTickEnabled(false);
+	//the widget only needs its tick to put itself on screen and draw while it's showing, focus turns it on and off. SetComponentTickEnabled does nothing this early
+	PrimaryComponentTick.bStartWithTickEnabled = false;
 
 	InteractionTime = 0.f; 
 	InteractionDistance = 200.f;
 	InteractableNameText = FText::FromString("Interactable Object");
 	InteractableActionText = FText::FromString("Interact");
 	bAllowMultipleInteractors = true; 
+	AssistPriority = 0.f;
 
 	Space = EWidgetSpace::Screen;
 	DrawSize = FIntPoint(600, 100);
@@ -24,6 +28,17 @@ UInteractionComponent::UInteractionComponent()
 
 }
 
+void UInteractionComponent::InitWidget()
+{
+#if !UE_SERVER
+	if (GetNetMode() != NM_DedicatedServer)
+	{
+		SURVIVAL_LLM_SCOPE(Interaction);
+		Super::InitWidget();
+	}
+#endif
+}
+
 void UInteractionComponent::SetInteractableNameText(const FText& NewNameText)
 {
 	InteractableNameText = NewNameText;
@@ -36,6 +51,20 @@ void UInteractionComponent::SetInteractableActionText(const FText& NewActionText
 	RefreshWidget();
 }
 
+void UInteractionComponent::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	SurvivalMemory::TrackCreated(this, SurvivalMemory::ECategory::Interactables);
+}
+
+void UInteractionComponent::BeginDestroy()
+{
+	SurvivalMemory::TrackDestroyed(this, SurvivalMemory::ECategory::Interactables);
+
+	Super::BeginDestroy();
+}
+
 void UInteractionComponent::Deactivate()
 {
 	//call super function because we inherit from widget component which has its own deactivate to so we have to call that as well
@@ -66,6 +95,10 @@ bool UInteractionComponent::CanInteract(class ASurvivalCharacter* Character) con
 
 void UInteractionComponent::RefreshWidget()
 {
+#if !UE_SERVER
+	SURVIVAL_SCOPE_CYCLE_COUNTER(InteractionRefreshWidget);
+	SURVIVAL_INC_COUNTER(InteractionWidgetRefreshes, 1);
+
 	//make sure interaction card is not hidden and that we are not the server as server has no UI
 	if (!bHiddenInGame && GetOwner()->GetNetMode() != NM_DedicatedServer)
 	{
@@ -75,6 +108,7 @@ void UInteractionComponent::RefreshWidget()
 			InteractionWidget->UpdateInteractionWidget(this);
 		}
 	}
+#endif
 }
 
 void UInteractionComponent::BeginFocus(class ASurvivalCharacter* Character)
@@ -85,15 +119,20 @@ void UInteractionComponent::BeginFocus(class ASurvivalCharacter* Character)
 		return;
 	}
 
+	SURVIVAL_SCOPE_CYCLE_COUNTER(InteractionFocus);
+	SURVIVAL_INC_COUNTER(InteractionFocusChanges, 1);
+
 	//broadcasting delegate -- allows interaction to do something custom 
 	OnBeginFocus.Broadcast(Character);
 
 
+#if !UE_SERVER
 	//if you are not the server, not doing on server because server doesnt have anyone playing the game 
 	if (GetNetMode() != NM_DedicatedServer)
 	{
 		//show UI
 		SetHiddenInGame(false);
+		SetComponentTickEnabled(true);
 		//grab any visual primtive components
 		for (auto& VisualComp : GetOwner()->GetComponentsByClass(UPrimitiveComponent::StaticClass()))
 		{
@@ -104,19 +143,28 @@ void UInteractionComponent::BeginFocus(class ASurvivalCharacter* Character)
 			}
 		}
 	}
+#endif
 
 	RefreshWidget();
 }
 
 void UInteractionComponent::EndFocus(ASurvivalCharacter* Character)
 {
+	SURVIVAL_SCOPE_CYCLE_COUNTER(InteractionFocus);
+	SURVIVAL_INC_COUNTER(InteractionFocusChanges, 1);
+
 	//broadcasting delegate -- allows interaction to do something custom 
 	OnEndFocus.Broadcast(Character);
 	
+#if !UE_SERVER
 	if (GetNetMode() != NM_DedicatedServer)
 	{
 		SetHiddenInGame(true);
 
+		//a hidden screen space widget is taken off the screen by its own tick, which we're about to turn off, so do it here
+		RemoveWidgetFromScreen();
+		SetComponentTickEnabled(false);
+
 		for (auto& VisualComp : GetOwner()->GetComponentsByClass(UPrimitiveComponent::StaticClass()))
 		{
 			if (UPrimitiveComponent* Prim = Cast<UPrimitiveComponent>(VisualComp))
@@ -125,6 +173,7 @@ void UInteractionComponent::EndFocus(ASurvivalCharacter* Character)
 			}
 		}
 	}
+#endif
 }
 
 void UInteractionComponent::BeginInteract(class ASurvivalCharacter* Character)
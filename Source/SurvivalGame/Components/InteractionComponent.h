@@ -44,6 +44,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
 	bool bAllowMultipleInteractors;
 
+	//How much the interaction assist prefers this over other interactables near it, from 0 to 1. Lets important things like doors win over a pile of loot
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction", meta = (ClampMin = 0.0, ClampMax = 1.0))
+	float AssistPriority;
+
 	//Call this to change the name of the interactable. Will also refresh the interaction widget
 	UFUNCTION(BlueprintCallable, Category = "Interaction")
 	void SetInteractableNameText(const FText& NewNameText);
@@ -73,6 +77,13 @@ protected:
 	//Called when the game starts
 	virtual void Deactivate() override; 
 
+	//The server never shows interaction cards, so don't let it build a widget
+	virtual void InitWidget() override;
+
+	//Counted for Survival.MemReport
+	virtual void PostInitProperties() override;
+	virtual void BeginDestroy() override;
+
 	//allow you to check if a given character is allowed to interact
 	bool CanInteract(class ASurvivalCharacter* Character) const;
 
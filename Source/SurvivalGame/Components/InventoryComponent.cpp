@@ -2,15 +2,29 @@
 
 
 #include "InventoryComponent.h"
+#include "SurvivalGame.h"
+#include "Items/Item.h"
+#include "Components/ItemLifecycleComponent.h"
+#include "Framework/SurvivalMemoryReport.h"
+#include "World/Pickup.h"
+#include "Engine/ActorChannel.h"
+#include "Net/DataBunch.h"
+#include "Net/UnrealNetwork.h"
+
+#define LOCTEXT_NAMESPACE "Inventory"
 
 // Sets default values for this component's properties
 UInventoryComponent::UInventoryComponent()
 {
-	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
-	// off to improve performance if you don't need them.
-	PrimaryComponentTick.bCanEverTick = true;
+	//everything here happens in response to adds, removes and replication, there's nothing to do per frame.
+	//never registering a tick means a server full of loot containers doesn't pay for one per inventory
+	PrimaryComponentTick.bCanEverTick = false;
 
-	// ...
+	SetIsReplicated(true);
+
+	WeightCapacity = 80.f;
+	Capacity = 20;
+	ReplicatedItemsKey = 0;
 }
 
 
@@ -20,15 +34,502 @@ void UInventoryComponent::BeginPlay()
 	Super::BeginPlay();
 
 	// ...
-	
+
 }
 
 
-// Called every frame
-void UInventoryComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+void UInventoryComponent::PostInitProperties()
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+	Super::PostInitProperties();
 
-	// ...
+	SurvivalMemory::TrackCreated(this, SurvivalMemory::ECategory::Inventories);
+}
+
+void UInventoryComponent::BeginDestroy()
+{
+	SurvivalMemory::TrackDestroyed(this, SurvivalMemory::ECategory::Inventories);
+
+	Super::BeginDestroy();
+}
+
+FItemAddResult UInventoryComponent::TryAddItem(class UItem* Item)
+{
+	return TryAddItem_Internal(Item);
+}
+
+FItemAddResult UInventoryComponent::TryAddItemFromClass(TSubclassOf<class UItem> ItemClass, const int32 Quantity)
+{
+	SURVIVAL_LLM_SCOPE(Items);
+
+	UItem* Item = NewObject<UItem>(GetOwner(), ItemClass);
+	Item->SetQuantity(Quantity);
+	return TryAddItem_Internal(Item);
+}
+
+int32 UInventoryComponent::ConsumeItem(class UItem* Item)
+{
+	if (Item)
+	{
+		return ConsumeItem(Item, Item->GetQuantity());
+	}
+	return 0;
+}
+
+int32 UInventoryComponent::ConsumeItem(class UItem* Item, const int32 Quantity)
+{
+	if (GetOwner() && GetOwner()->HasAuthority() && Item)
+	{
+		const int32 RemoveQuantity = FMath::Min(Quantity, Item->GetQuantity());
+
+		//we shouldnt have a negative amount of the item after the consume
+		ensure(!(Item->GetQuantity() - RemoveQuantity < 0));
+
+		{
+			//scoped so it doesnt overlap RemoveItems own timer
+			SURVIVAL_SCOPE_CYCLE_COUNTER(InventoryMutation);
+			SURVIVAL_INC_COUNTER(InventoryMutations, 1);
+
+			Item->SetQuantity(Item->GetQuantity() - RemoveQuantity);
+		}
+
+		//we now have zero of this item, remove it from the inventory
+		if (Item->GetQuantity() <= 0)
+		{
+			RemoveItem(Item);
+		}
+
+		return RemoveQuantity;
+	}
+
+	return 0;
+}
+
+bool UInventoryComponent::RemoveItem(class UItem* Item)
+{
+	if (GetOwner() && GetOwner()->HasAuthority())
+	{
+		if (Item)
+		{
+			SURVIVAL_SCOPE_CYCLE_COUNTER(InventoryMutation);
+			SURVIVAL_INC_COUNTER(InventoryMutations, 1);
+
+			Items.RemoveSingle(Item);
+			ReplicatedItemsKey++;
+
+			//consumed items are already at zero, anything else is leaving with whatever is left in its stack
+			if (Item->GetQuantity() > 0)
+			{
+				OnItemQuantityChanged.Broadcast(Item, -Item->GetQuantity());
+			}
+
+			//the item isnt ours anymore, this also stops it decaying
+			Item->OwningInventory = nullptr;
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool UInventoryComponent::HasItem(TSubclassOf<class UItem> ItemClass, const int32 Quantity /*= 1*/) const
+{
+	if (UItem* ItemToFind = FindItemByClass(ItemClass))
+	{
+		return ItemToFind->GetQuantity() >= Quantity;
+	}
+	return false;
+}
+
+UItem* UInventoryComponent::FindItem(class UItem* Item) const
+{
+	if (Item)
+	{
+		for (auto& InvItem : Items)
+		{
+			if (InvItem && InvItem->GetClass() == Item->GetClass())
+			{
+				return InvItem;
+			}
+		}
+	}
+	return nullptr;
+}
+
+UItem* UInventoryComponent::FindItemByClass(TSubclassOf<class UItem> ItemClass) const
+{
+	for (auto& InvItem : Items)
+	{
+		if (InvItem && InvItem->GetClass() == ItemClass)
+		{
+			return InvItem;
+		}
+	}
+	return nullptr;
+}
+
+float UInventoryComponent::GetCurrentWeight() const
+{
+	float Weight = 0.f;
+
+	for (auto& Item : Items)
+	{
+		if (Item)
+		{
+			Weight += Item->GetStackWeight();
+		}
+	}
+
+	return Weight;
+}
+
+TArray<class UItem*> UInventoryComponent::GetItems() const
+{
+	if (PredictedItems.Num() == 0)
+	{
+		return Items;
+	}
+
+	TArray<UItem*> AllItems(Items);
+	AllItems.Append(PredictedItems);
+	return AllItems;
+}
+
+SIZE_T UInventoryComponent::GetStorageSize() const
+{
+	return Items.GetAllocatedSize() + PredictedItems.GetAllocatedSize() + PendingPredictions.GetAllocatedSize();
+}
+
+bool UInventoryComponent::AddPredictedItem(TSubclassOf<class UItem> ItemClass, const int32 Quantity, const int32 PredictionKey, class APickup* PredictedPickup)
+{
+	if (!GetOwner() || GetOwner()->HasAuthority() || !ItemClass || Quantity <= 0 || PredictionKey <= 0)
+	{
+		return false;
+	}
+
+	SURVIVAL_SCOPE_CYCLE_COUNTER(InventoryMutation);
+	SURVIVAL_INC_COUNTER(InventoryMutations, 1);
+	SURVIVAL_LLM_SCOPE(Inventory);
+
+	const UItem* ItemDefaults = ItemClass->GetDefaultObject<UItem>();
+
+	//a partial pickup would leave something on the ground, which is harder to fake, so just wait for the server on those
+	if (!FMath::IsNearlyZero(ItemDefaults->Weight) && GetCurrentWeight() + ItemDefaults->Weight * Quantity > GetWeightCapacity())
+	{
+		return false;
+	}
+
+	//stack onto what we have, including something we've already predicted, so we never show two stacks of the same item
+	UItem* Item = nullptr;
+
+	if (ItemDefaults->bStackable)
+	{
+		for (UItem* InvItem : GetItems())
+		{
+			if (InvItem && InvItem->GetClass() == ItemClass)
+			{
+				Item = InvItem;
+				break;
+			}
+		}
+
+		if (Item && Item->GetQuantity() + Quantity > Item->MaxStackSize)
+		{
+			return false;
+		}
+	}
+
+	if (!Item)
+	{
+		if (Items.Num() + PredictedItems.Num() + 1 > GetCapacity())
+		{
+			return false;
+		}
+
+		SURVIVAL_LLM_SCOPE(Items);
+
+		//this item is never added to Items, it just stands in for the real one until the server sends it
+		Item = NewObject<UItem>(GetOwner(), ItemClass);
+		Item->SetQuantity(0);
+		PredictedItems.Add(Item);
+	}
+
+	Item->PredictedQuantity += Quantity;
+
+	FPredictedPickup Prediction;
+	Prediction.PredictionKey = PredictionKey;
+	Prediction.Item = Item;
+	Prediction.Quantity = Quantity;
+	Prediction.Pickup = PredictedPickup;
+	PendingPredictions.Add(Prediction);
+
+	OnInventoryUpdated.Broadcast();
+
+	return true;
+}
+
+void UInventoryComponent::AckPrediction(const int32 PredictionKey, const bool bTookAll)
+{
+	//keys only go up, so anything older has already been acked
+	if (GetOwner() && GetOwner()->HasAuthority() && PredictionKey > PredictionAck.PredictionKey)
+	{
+		//keys we never heard about, i.e. their begin interact was lost, shift in as not taken
+		const int32 Age = PredictionKey - PredictionAck.PredictionKey;
+		PredictionAck.TookAllMask = Age < 32 ? PredictionAck.TookAllMask << Age : 0;
+		PredictionAck.TookAllMask |= bTookAll ? 1u : 0u;
+		PredictionAck.PredictionKey = PredictionKey;
+	}
+}
+
+void UInventoryComponent::OnRep_PredictionAck()
+{
+	//the real items arrive in the same update as the ack, so taking the predicted amounts off here swaps one for the other without a flicker
+	for (const FPredictedPickup& Prediction : PendingPredictions)
+	{
+		if (Prediction.PredictionKey > PredictionAck.PredictionKey)
+		{
+			continue;
+		}
+
+		if (UItem* Item = Prediction.Item.Get())
+		{
+			Item->PredictedQuantity -= Prediction.Quantity;
+
+			if (Item->PredictedQuantity <= 0)
+			{
+				PredictedItems.RemoveSingle(Item);
+			}
+		}
+
+		//the server didnt take it all, so put the pickup back. If it did, it stays hidden until the server destroys it
+		if (APickup* Pickup = Prediction.Pickup.Get())
+		{
+			if (!PredictionAck.TookAll(Prediction.PredictionKey))
+			{
+				Pickup->SetPredictedTaken(false);
+			}
+		}
+	}
+
+	const int32 AckedKey = PredictionAck.PredictionKey;
+	PendingPredictions.RemoveAll([AckedKey](const FPredictedPickup& Prediction) { return Prediction.PredictionKey <= AckedKey; });
+
+	OnInventoryUpdated.Broadcast();
+}
+
+void UInventoryComponent::SetWeightCapacity(const float NewWeightCapacity)
+{
+	WeightCapacity = NewWeightCapacity;
+	OnInventoryUpdated.Broadcast();
+}
+
+void UInventoryComponent::SetCapacity(const int32 NewCapacity)
+{
+	Capacity = NewCapacity;
+	OnInventoryUpdated.Broadcast();
+}
+
+void UInventoryComponent::GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(UInventoryComponent, Items);
+	DOREPLIFETIME_CONDITION(UInventoryComponent, PredictionAck, COND_OwnerOnly);
+}
+
+bool UInventoryComponent::ReplicateSubobjects(class UActorChannel* Channel, class FOutBunch* Bunch, FReplicationFlags* RepFlags)
+{
+	SURVIVAL_SCOPE_CYCLE_COUNTER(InventoryReplication);
+
+	bool bWroteSomething = Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
+
+	//only go through the items if something in the inventory changed, then only send the items whose repkey changed
+	if (Channel->KeyNeedsToReplicate(0, ReplicatedItemsKey))
+	{
+		const int64 StartBits = Bunch->GetNumBits();
+		int32 NumReplicated = 0;
+
+		for (auto& Item : Items)
+		{
+			if (Item && Channel->KeyNeedsToReplicate(Item->GetUniqueID(), Item->RepKey))
+			{
+				bWroteSomething |= Channel->ReplicateSubobject(Item, *Bunch, *RepFlags);
+				++NumReplicated;
+			}
+		}
+
+		SURVIVAL_INC_COUNTER(InventoryItemsReplicated, NumReplicated);
+		SURVIVAL_INC_COUNTER(InventoryBytesReplicated, (Bunch->GetNumBits() - StartBits + 7) / 8);
+	}
+
+	return bWroteSomething;
+}
+
+UItem* UInventoryComponent::AddItem(class UItem* Item, const int32 Quantity)
+{
+	if (GetOwner() && GetOwner()->HasAuthority())
+	{
+		UItem* NewItem = nullptr;
+
+		{
+			SURVIVAL_LLM_SCOPE(Items);
+
+			//the item passed in is only a template, make our own copy owned by our actor so it replicates through our channel
+			NewItem = NewObject<UItem>(GetOwner(), Item->GetClass());
+			NewItem->SetQuantity(Quantity);
+			NewItem->NextDecayTime = Item->NextDecayTime;
+		}
+
+		SURVIVAL_LLM_SCOPE(Inventory);
+
+		NewItem->OwningInventory = this;
+		NewItem->AddedToInventory(this);
+		Items.Add(NewItem);
+		NewItem->MarkDirtyForReplication();
+
+		OnItemQuantityChanged.Broadcast(NewItem, NewItem->GetQuantity());
+
+		if (UItemLifecycleComponent* ItemLifecycle = UItemLifecycleComponent::Get(this))
+		{
+			ItemLifecycle->ScheduleDecay(NewItem);
+		}
+
+		return NewItem;
+	}
+
+	return nullptr;
+}
+
+void UInventoryComponent::OnRep_Items()
+{
+	OnInventoryUpdated.Broadcast();
+}
+
+FItemAddResult UInventoryComponent::TryAddItem_Internal(class UItem* Item)
+{
+	if (GetOwner() && GetOwner()->HasAuthority() && Item)
+	{
+		SURVIVAL_SCOPE_CYCLE_COUNTER(InventoryMutation);
+		SURVIVAL_INC_COUNTER(InventoryMutations, 1);
+
+		const int32 AddAmount = Item->GetQuantity();
+
+		//topping up a stack we already have doesnt need a free slot, adding a new item does
+		const bool bHasFreeSlot = Items.Num() + 1 <= GetCapacity();
+
+		//items with a weight of zero dont require a weight check. This only checks a single unit fits, how much of a stack fits is worked out below
+		if (!FMath::IsNearlyZero(Item->Weight))
+		{
+			if (GetCurrentWeight() + Item->Weight > GetWeightCapacity())
+			{
+				return FItemAddResult::AddedNone(AddAmount, LOCTEXT("InventoryTooMuchWeightText", "Couldn't add item to Inventory. Carrying too much weight."));
+			}
+		}
+
+		//if the item is stackable, check if we already have it and add it to that stack
+		if (Item->bStackable)
+		{
+			//somehow the items quantity went over the max stack size. This shouldnt ever happen
+			ensure(Item->GetQuantity() <= Item->MaxStackSize);
+
+			if (UItem* ExistingItem = FindItem(Item))
+			{
+				if (ExistingItem->GetQuantity() < ExistingItem->MaxStackSize)
+				{
+					//find the maximum amount of the item we could take due to the stack size
+					const int32 CapacityMaxAddAmount = ExistingItem->MaxStackSize - ExistingItem->GetQuantity();
+					int32 ActualAddAmount = FMath::Min(AddAmount, CapacityMaxAddAmount);
+
+					FText ErrorText = LOCTEXT("InventoryPartialAddText", "Couldn't add all of the item to your inventory.");
+
+					//adjust based on how much weight we can carry
+					if (!FMath::IsNearlyZero(Item->Weight))
+					{
+						const int32 WeightMaxAddAmount = FMath::FloorToInt((WeightCapacity - GetCurrentWeight()) / Item->Weight);
+						ActualAddAmount = FMath::Min(ActualAddAmount, WeightMaxAddAmount);
+
+						if (ActualAddAmount < AddAmount)
+						{
+							ErrorText = FText::Format(LOCTEXT("InventoryStackTooMuchWeightText", "Couldn't add entire stack of {0} to Inventory."), Item->ItemDisplayName);
+						}
+					}
+					else if (ActualAddAmount < AddAmount)
+					{
+						ErrorText = FText::Format(LOCTEXT("InventoryStackCapacityFullText", "Couldn't add entire stack of {0} to Inventory. Inventory was full."), Item->ItemDisplayName);
+					}
+
+					//we couldnt add any of the item to our inventory
+					if (ActualAddAmount <= 0)
+					{
+						return FItemAddResult::AddedNone(AddAmount, LOCTEXT("InventoryNothingAddedText", "Couldn't add item to inventory."));
+					}
+
+					ExistingItem->SetQuantity(ExistingItem->GetQuantity() + ActualAddAmount);
+
+					//if we somehow get more of the item than the max stack size then something is wrong with our math
+					ensure(ExistingItem->GetQuantity() <= ExistingItem->MaxStackSize);
+
+					if (ActualAddAmount < AddAmount)
+					{
+						return FItemAddResult::AddedSome(AddAmount, ActualAddAmount, ErrorText);
+					}
+					else
+					{
+						return FItemAddResult::AddedAll(AddAmount);
+					}
+				}
+				else
+				{
+					return FItemAddResult::AddedNone(AddAmount, FText::Format(LOCTEXT("InventoryFullStackText", "Couldn't add {0}. You already have a full stack of this item."), Item->ItemDisplayName));
+				}
+			}
+			else
+			{
+				if (!bHasFreeSlot)
+				{
+					return FItemAddResult::AddedNone(AddAmount, LOCTEXT("InventoryCapacityFullText", "Couldn't add item to Inventory. Inventory is full."));
+				}
+
+				//since we dont have any of this item, we'll start a new stack with as much of it as we can carry
+				int32 ActualAddAmount = AddAmount;
+
+				if (!FMath::IsNearlyZero(Item->Weight))
+				{
+					ActualAddAmount = FMath::Min(ActualAddAmount, FMath::FloorToInt((WeightCapacity - GetCurrentWeight()) / Item->Weight));
+				}
+
+				if (ActualAddAmount <= 0)
+				{
+					return FItemAddResult::AddedNone(AddAmount, LOCTEXT("InventoryNothingAddedText", "Couldn't add item to inventory."));
+				}
+
+				AddItem(Item, ActualAddAmount);
+
+				if (ActualAddAmount < AddAmount)
+				{
+					return FItemAddResult::AddedSome(AddAmount, ActualAddAmount, FText::Format(LOCTEXT("InventoryStackTooMuchWeightText", "Couldn't add entire stack of {0} to Inventory."), Item->ItemDisplayName));
+				}
+
+				return FItemAddResult::AddedAll(AddAmount);
+			}
+		}
+		else //item isnt stackable
+		{
+			//non-stackables should always have a quantity of 1
+			ensure(Item->GetQuantity() == 1);
+
+			if (!bHasFreeSlot)
+			{
+				return FItemAddResult::AddedNone(AddAmount, LOCTEXT("InventoryCapacityFullText", "Couldn't add item to Inventory. Inventory is full."));
+			}
+
+			AddItem(Item, AddAmount);
+
+			return FItemAddResult::AddedAll(AddAmount);
+		}
+	}
+
+	return FItemAddResult::AddedNone(-1, LOCTEXT("InventoryErrorText", "Couldn't add item to inventory."));
 }
 
+#undef LOCTEXT_NAMESPACE
@@ -6,23 +6,240 @@
 #include "Components/ActorComponent.h"
 #include "InventoryComponent.generated.h"
 
+//Called when the inventory is changed and the UI needs an update
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnInventoryUpdated);
+
+//[Server] Called when the quantity of an item in the inventory changes, including when it's added or removed
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnItemQuantityChanged, class UItem*, Item, int32, QuantityDelta);
+
+UENUM(BlueprintType)
+enum class EItemAddResult : uint8
+{
+	IAR_NoItemsAdded UMETA(DisplayName = "No items added"),
+	IAR_SomeItemsAdded UMETA(DisplayName = "Some items added"),
+	IAR_AllItemsAdded UMETA(DisplayName = "All items added")
+};
+
+//Represents the result of adding an item to the inventory
+USTRUCT(BlueprintType)
+struct FItemAddResult
+{
+	GENERATED_BODY()
+
+public:
+
+	FItemAddResult() {};
+	FItemAddResult(int32 InItemQuantity) : AmountToGive(InItemQuantity), ActualAmountGiven(0) {};
+	FItemAddResult(int32 InItemQuantity, int32 InQuantityAdded) : AmountToGive(InItemQuantity), ActualAmountGiven(InQuantityAdded) {};
+
+	//The amount of the item that we tried to add
+	UPROPERTY(BlueprintReadOnly, Category = "Item Add Result")
+	int32 AmountToGive = 0;
+
+	//The amount of the item that was actually added in the end. Maybe we tried adding 10 items, but only 8 could be added because of capacity/weight
+	UPROPERTY(BlueprintReadOnly, Category = "Item Add Result")
+	int32 ActualAmountGiven = 0;
+
+	//The result
+	UPROPERTY(BlueprintReadOnly, Category = "Item Add Result")
+	EItemAddResult Result = EItemAddResult::IAR_NoItemsAdded;
+
+	//If something went wrong, like we didnt have enough capacity or carrying too much weight this contains the reason why
+	UPROPERTY(BlueprintReadOnly, Category = "Item Add Result")
+	FText ErrorText = FText::GetEmpty();
+
+	//Helpers
+	static FItemAddResult AddedNone(const int32 InItemQuantity, const FText& ErrorText)
+	{
+		FItemAddResult AddedNoneResult(InItemQuantity);
+		AddedNoneResult.Result = EItemAddResult::IAR_NoItemsAdded;
+		AddedNoneResult.ErrorText = ErrorText;
+
+		return AddedNoneResult;
+	}
+
+	static FItemAddResult AddedSome(const int32 InItemQuantity, const int32 ActualAmountGiven, const FText& ErrorText)
+	{
+		FItemAddResult AddedSomeResult(InItemQuantity, ActualAmountGiven);
+
+		AddedSomeResult.Result = EItemAddResult::IAR_SomeItemsAdded;
+		AddedSomeResult.ErrorText = ErrorText;
+
+		return AddedSomeResult;
+	}
+
+	static FItemAddResult AddedAll(const int32 InItemQuantity)
+	{
+		FItemAddResult AddAllResult(InItemQuantity, InItemQuantity);
+
+		AddAllResult.Result = EItemAddResult::IAR_AllItemsAdded;
+
+		return AddAllResult;
+	}
+
+};
+
+//Tells the owning client the server has dealt with every pickup it predicted, up to and including PredictionKey
+USTRUCT()
+struct FPredictionAck
+{
+	GENERATED_BODY()
+
+	FPredictionAck()
+	{
+		PredictionKey = 0;
+		TookAllMask = 0;
+	}
+
+	UPROPERTY()
+	int32 PredictionKey;
+
+	//Bit i is set if the pickup for PredictionKey - i went entirely into the inventory, so the client should keep it hidden until it's
+	//destroyed. Several acks can arrive in one update, so the last 32 keys are kept rather than just the newest
+	UPROPERTY()
+	uint32 TookAllMask;
+
+	bool TookAll(const int32 Key) const
+	{
+		const int32 Age = PredictionKey - Key;
+		return Age >= 0 && Age < 32 && (TookAllMask & (1u << Age)) != 0;
+	}
+};
 
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class SURVIVALGAME_API UInventoryComponent : public UActorComponent
 {
 	GENERATED_BODY()
 
-public:	
+	//items need to be able to bump ReplicatedItemsKey when they change
+	friend class UItem;
+
+public:
 	// Sets default values for this component's properties
 	UInventoryComponent();
 
+	//[Server] Add an item to the inventory. The item passed in is only used as a template, the inventory makes its own copy
+	FItemAddResult TryAddItem(class UItem* Item);
+
+	//[Server] Add an item to the inventory using the item class instead of an item instance
+	FItemAddResult TryAddItemFromClass(TSubclassOf<class UItem> ItemClass, const int32 Quantity);
+
+	//[Server] Take some quantity away from the item, and remove it from the inventory when it reaches zero. Returns how many were removed
+	int32 ConsumeItem(class UItem* Item);
+	int32 ConsumeItem(class UItem* Item, const int32 Quantity);
+
+	//[Server] Remove the item from the inventory
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	bool RemoveItem(class UItem* Item);
+
+	//Return true if we have a given amount of an item
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	bool HasItem(TSubclassOf<class UItem> ItemClass, const int32 Quantity = 1) const;
+
+	//Return the first item with the same class as a given item
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	class UItem* FindItem(class UItem* Item) const;
+
+	//Return the first item with the same class as ItemClass
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	class UItem* FindItemByClass(TSubclassOf<class UItem> ItemClass) const;
+
+	//Get the current weight of the inventory
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	float GetCurrentWeight() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	void SetWeightCapacity(const float NewWeightCapacity);
+
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	void SetCapacity(const int32 NewCapacity);
+
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	FORCEINLINE float GetWeightCapacity() const { return WeightCapacity; };
+
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	FORCEINLINE int32 GetCapacity() const { return Capacity; };
+
+	//The items in the inventory. On the owning client this includes items it has predicted picking up
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	TArray<class UItem*> GetItems() const;
+
+	//Bytes allocated for our item and prediction arrays, for the memory report. The items themselves aren't included
+	SIZE_T GetStorageSize() const;
+
+	//[Client] Show Quantity of an item in the inventory straight away, before the server confirms it. Only predicts pickups that
+	//look like they'll fit entirely, and returns false otherwise. The prediction is undone when the server acks PredictionKey
+	bool AddPredictedItem(TSubclassOf<class UItem> ItemClass, const int32 Quantity, const int32 PredictionKey, class APickup* PredictedPickup);
+
+	//[Server] Let the owning client know we've dealt with its predictions up to PredictionKey
+	void AckPrediction(const int32 PredictionKey, const bool bTookAll);
+
+	//Bumped every time an item is added, removed or modified. Lets the owner tell if the inventory changed since it last looked
+	FORCEINLINE int32 GetReplicatedItemsKey() const { return ReplicatedItemsKey; }
+
+	UPROPERTY(BlueprintAssignable, Category = "Inventory")
+	FOnInventoryUpdated OnInventoryUpdated;
+
+	UPROPERTY(BlueprintAssignable, Category = "Inventory")
+	FOnItemQuantityChanged OnItemQuantityChanged;
+
 protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
 
-public:	
-	// Called every frame
-	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	//The maximum weight the inventory can hold. For players, backpacks and other items increase this limit
+	UPROPERTY(EditDefaultsOnly, Category = "Inventory")
+	float WeightCapacity;
+
+	//The maximum number of items the inventory can hold. For players, backpacks and other items increase this limit
+	UPROPERTY(EditDefaultsOnly, Category = "Inventory", meta = (ClampMin = 0, ClampMax = 200))
+	int32 Capacity;
+
+	//The items currently in our inventory
+	UPROPERTY(ReplicatedUsing = OnRep_Items, VisibleAnywhere, Category = "Inventory")
+	TArray<class UItem*> Items;
+
+	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual bool ReplicateSubobjects(class UActorChannel* Channel, class FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
+
+	//Counted for Survival.MemReport
+	virtual void PostInitProperties() override;
+	virtual void BeginDestroy() override;
+
+private:
+
+	//Don't call Items.Add() directly, use this function instead, as it handles replication and ownership. Adds a copy of Item holding Quantity of it
+	class UItem* AddItem(class UItem* Item, const int32 Quantity);
+
+	UFUNCTION()
+	void OnRep_Items();
+
+	//Internal, non-BP exposed add item function. Don't call this directly, use TryAddItem() or TryAddItemFromClass() instead
+	FItemAddResult TryAddItem_Internal(class UItem* Item);
+
+	//Like the RepKey on an item, this is bumped whenever the item array or an item in it changes, so we only look through the items when we need to
+	UPROPERTY()
+	int32 ReplicatedItemsKey;
+
+	UPROPERTY(ReplicatedUsing = OnRep_PredictionAck)
+	FPredictionAck PredictionAck;
+
+	UFUNCTION()
+	void OnRep_PredictionAck();
+
+	struct FPredictedPickup
+	{
+		int32 PredictionKey;
+		TWeakObjectPtr<class UItem> Item;
+		int32 Quantity;
+		TWeakObjectPtr<class APickup> Pickup;
+	};
+
+	//[Client] Pickups we've predicted that the server hasn't acked yet
+	TArray<FPredictedPickup> PendingPredictions;
+
+	//[Client] Local stand-ins for items we've predicted picking up but didnt have a stack of yet
+	UPROPERTY()
+	TArray<class UItem*> PredictedItems;
 
-		
 };
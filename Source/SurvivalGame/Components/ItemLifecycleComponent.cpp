@@ -0,0 +1,169 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ItemLifecycleComponent.h"
+#include "Items/Item.h"
+#include "Components/InventoryComponent.h"
+#include "Framework/SurvivalGameGameModeBase.h"
+#include "World/Pickup.h"
+#include "Framework/SurvivalTickAudit.h"
+#include "Engine/World.h"
+
+UItemLifecycleComponent::UItemLifecycleComponent()
+{
+	//only ticks while something is scheduled
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	MaxEntriesPerFrame = 256;
+	MaxMillisecondsPerFrame = 0.5f;
+}
+
+UItemLifecycleComponent* UItemLifecycleComponent::Get(const UObject* WorldContextObject)
+{
+	if (UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr)
+	{
+		if (ASurvivalGameGameModeBase* GameMode = World->GetAuthGameMode<ASurvivalGameGameModeBase>())
+		{
+			return GameMode->ItemLifecycle;
+		}
+	}
+
+	return nullptr;
+}
+
+void UItemLifecycleComponent::ScheduleDespawn(class AActor* Actor, const float Delay)
+{
+	if (Actor && Delay > 0.f)
+	{
+		Schedule(Actor, GetWorld()->GetTimeSeconds() + Delay, ELifecycleAction::Despawn);
+	}
+}
+
+void UItemLifecycleComponent::ScheduleDecay(class UItem* Item)
+{
+	if (Item && Item->DecayInterval > 0.f && Item->GetQuantity() > 0)
+	{
+		const float CurrentTime = GetWorld()->GetTimeSeconds();
+
+		//a copy of an item that was already decaying keeps the time it was due, anything else starts a fresh interval.
+		//the item remembers when its next decay is due, so any older entry for it still in the heap gets ignored
+		if (Item->NextDecayTime <= CurrentTime)
+		{
+			Item->NextDecayTime = CurrentTime + Item->DecayInterval;
+		}
+
+		Schedule(Item, Item->NextDecayTime, ELifecycleAction::Decay);
+	}
+}
+
+void UItemLifecycleComponent::Schedule(UObject* Object, const float Time, const ELifecycleAction Action)
+{
+	FLifecycleEntry Entry;
+	Entry.Time = Time;
+	Entry.Object = Object;
+	Entry.Action = Action;
+
+	Entries.HeapPush(Entry);
+
+	SetComponentTickEnabled(true);
+}
+
+void UItemLifecycleComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	SURVIVAL_TICK_AUDIT_SCOPE();
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	const float CurrentTime = GetWorld()->GetTimeSeconds();
+	const double EndTime = FPlatformTime::Seconds() + MaxMillisecondsPerFrame / 1000.0;
+
+	//destroy everything that expired this frame in one go at the end, rather than in between heap operations
+	TArray<AActor*, TInlineAllocator<64>> ActorsToDestroy;
+	TArray<UItem*, TInlineAllocator<64>> ItemsToReschedule;
+
+	int32 NumProcessed = 0;
+
+	//nothing due costs us one look at the top of the heap
+	while (Entries.Num() > 0 && Entries.HeapTop().Time <= CurrentTime && NumProcessed < MaxEntriesPerFrame)
+	{
+		FLifecycleEntry Entry;
+		Entries.HeapPop(Entry, false);
+		++NumProcessed;
+
+		UObject* Object = Entry.Object.Get();
+
+		//already picked up, destroyed or garbage collected
+		if (!Object || Object->IsPendingKill())
+		{
+			continue;
+		}
+
+		if (Entry.Action == ELifecycleAction::Despawn)
+		{
+			if (AActor* Actor = Cast<AActor>(Object))
+			{
+				ActorsToDestroy.Add(Actor);
+			}
+		}
+		else if (UItem* Item = Cast<UItem>(Object))
+		{
+			//a newer entry for this item exists, this one is stale
+			if (Item->NextDecayTime == Entry.Time && DecayItem(Item, ActorsToDestroy))
+			{
+				ItemsToReschedule.Add(Item);
+			}
+		}
+
+		//checking the clock is cheap, but not free, so only do it every few entries
+		if ((NumProcessed % 16) == 0 && FPlatformTime::Seconds() > EndTime)
+		{
+			break;
+		}
+	}
+
+	for (AActor* Actor : ActorsToDestroy)
+	{
+		Actor->Destroy();
+	}
+
+	//rescheduled after the loop, so an item can't come due again inside the same pass
+	for (UItem* Item : ItemsToReschedule)
+	{
+		ScheduleDecay(Item);
+	}
+
+	if (Entries.Num() == 0)
+	{
+		SetComponentTickEnabled(false);
+	}
+}
+
+bool UItemLifecycleComponent::DecayItem(class UItem* Item, TArray<class AActor*, TInlineAllocator<64>>& OutActorsToDestroy)
+{
+	//items in an inventory are consumed through it, so it removes them and replicates once they run out
+	if (UInventoryComponent* Inventory = Item->OwningInventory)
+	{
+		Inventory->ConsumeItem(Item, Item->DecayAmount);
+		return Item->GetQuantity() > 0;
+	}
+
+	//otherwise the item should be lying in the world as a pickup. If it's neither, it's been removed and is waiting for GC
+	APickup* Pickup = Cast<APickup>(Item->GetOuter());
+
+	if (!Pickup || Pickup->GetItem() != Item)
+	{
+		return false;
+	}
+
+	Item->SetQuantity(Item->GetQuantity() - Item->DecayAmount);
+
+	//the whole stack has rotted away
+	if (Item->GetQuantity() <= 0)
+	{
+		OutActorsToDestroy.Add(Pickup);
+		return false;
+	}
+
+	return true;
+}
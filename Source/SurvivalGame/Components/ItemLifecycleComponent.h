@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "ItemLifecycleComponent.generated.h"
+
+/**
+ * Despawns dropped pickups and decays perishable items for the whole world, instead of every item having its own timer or tick.
+ * Expiry times are kept in a single min-heap, so each frame only looks at the entries that are actually due, and work is capped
+ * at MaxEntriesPerFrame and MaxMillisecondsPerFrame. Anything left over carries on next frame.
+ * Lives on the game mode, so it only exists on the server.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class SURVIVALGAME_API UItemLifecycleComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UItemLifecycleComponent();
+
+	//Find the lifecycle manager for the world the object is in. Null on clients
+	static UItemLifecycleComponent* Get(const UObject* WorldContextObject);
+
+	//Destroy the actor after Delay seconds, unless it's already been destroyed by then, i.e. picked up
+	UFUNCTION(BlueprintCallable, Category = "Item Lifecycle")
+	void ScheduleDespawn(class AActor* Actor, const float Delay);
+
+	//Start decaying an item if it's perishable. Called once when an item enters the world, in an inventory or a pickup.
+	//If the item already has a decay due, i.e. it was copied from one that was decaying, it keeps that time
+	void ScheduleDecay(class UItem* Item);
+
+	//The most due entries we'll process in a single frame
+	UPROPERTY(EditDefaultsOnly, Category = "Item Lifecycle", meta = (ClampMin = 1))
+	int32 MaxEntriesPerFrame;
+
+	//Stop processing entries for this frame once we've spent this long
+	UPROPERTY(EditDefaultsOnly, Category = "Item Lifecycle", meta = (ClampMin = 0.0))
+	float MaxMillisecondsPerFrame;
+
+protected:
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	enum class ELifecycleAction : uint8
+	{
+		Despawn,
+		Decay
+	};
+
+	struct FLifecycleEntry
+	{
+		float Time;
+		TWeakObjectPtr<UObject> Object;
+		ELifecycleAction Action;
+
+		//sorts the heap so the soonest entry is on top
+		bool operator<(const FLifecycleEntry& Other) const { return Time < Other.Time; }
+	};
+
+	void Schedule(UObject* Object, const float Time, const ELifecycleAction Action);
+
+	//Take some quantity off the item. Returns true if there's anything left of it to keep decaying
+	bool DecayItem(class UItem* Item, TArray<class AActor*, TInlineAllocator<64>>& OutActorsToDestroy);
+
+	//Every pending despawn and decay, as a min-heap on Time
+	TArray<FLifecycleEntry> Entries;
+
+};
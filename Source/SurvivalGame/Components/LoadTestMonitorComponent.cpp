@@ -0,0 +1,172 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LoadTestMonitorComponent.h"
+#include "Framework/SurvivalGameGameModeBase.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "TimerManager.h"
+
+ULoadTestMonitorComponent::ULoadTestMonitorComponent()
+{
+	ReportInterval = 10.f;
+
+	bRecording = false;
+	TickStartTime = 0.0;
+	LastReportTime = 0.0;
+}
+
+ULoadTestMonitorComponent* ULoadTestMonitorComponent::Get(const UObject* WorldContextObject)
+{
+	if (UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr)
+	{
+		if (ASurvivalGameGameModeBase* GameMode = World->GetAuthGameMode<ASurvivalGameGameModeBase>())
+		{
+			return GameMode->LoadTestMonitor;
+		}
+	}
+
+	return nullptr;
+}
+
+void ULoadTestMonitorComponent::RecordServerRPC(const AActor* Actor)
+{
+	ULoadTestMonitorComponent* Monitor = Get(Actor);
+
+	if (Monitor && Monitor->bRecording)
+	{
+		if (UNetConnection* Connection = Actor->GetNetConnection())
+		{
+			++Monitor->RPCCounts.FindOrAdd(Connection);
+		}
+	}
+}
+
+void ULoadTestMonitorComponent::RecordServerMoves(const AActor* Actor, const double Seconds, const int32 NumMoves)
+{
+	ULoadTestMonitorComponent* Monitor = Get(Actor);
+
+	if (Monitor && Monitor->bRecording)
+	{
+		if (UNetConnection* Connection = Actor->GetNetConnection())
+		{
+			FMoveRecord& Record = Monitor->MoveRecords.FindOrAdd(Connection);
+			++Record.RPCs;
+			Record.Moves += NumMoves;
+			Record.Seconds += Seconds;
+		}
+	}
+}
+
+void ULoadTestMonitorComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!FParse::Param(FCommandLine::Get(), TEXT("SurvivalLoadTest")))
+	{
+		return;
+	}
+
+	bRecording = true;
+	LastReportTime = FPlatformTime::Seconds();
+	ReportPath = FPaths::ProjectSavedDir() / TEXT("LoadTest") / FString::Printf(TEXT("LoadTest-%s.csv"), *FDateTime::Now().ToString());
+
+	FFileHelper::SaveStringToFile(TEXT("Time,Players,TickP50Ms,TickP90Ms,TickP99Ms,TickMaxMs,Connection,InBytesPerSecond,OutBytesPerSecond,GameplayRPCsPerSecond,MoveRPCsPerSecond,MovesPerSecond,MoveMsPerSecond\n"), *ReportPath);
+
+	WorldTickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &ULoadTestMonitorComponent::OnWorldTickStart);
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddUObject(this, &ULoadTestMonitorComponent::OnEndFrame);
+
+	GetWorld()->GetTimerManager().SetTimer(TimerHandle_Report, this, &ULoadTestMonitorComponent::WriteReport, ReportInterval, true);
+
+	UE_LOG(LogTemp, Log, TEXT("Load test monitor writing to %s"), *ReportPath);
+}
+
+void ULoadTestMonitorComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (bRecording)
+	{
+		WriteReport();
+
+		FWorldDelegates::OnWorldTickStart.Remove(WorldTickStartHandle);
+		FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+		bRecording = false;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ULoadTestMonitorComponent::OnWorldTickStart(ELevelTick TickType, float DeltaSeconds)
+{
+	//the first world to tick starts the frame, there's only the one on a dedicated server anyway
+	if (TickStartTime == 0.0)
+	{
+		TickStartTime = FPlatformTime::Seconds();
+	}
+}
+
+void ULoadTestMonitorComponent::OnEndFrame()
+{
+	if (TickStartTime > 0.0)
+	{
+		TickTimes.Add((float)((FPlatformTime::Seconds() - TickStartTime) * 1000.0));
+		TickStartTime = 0.0;
+	}
+}
+
+void ULoadTestMonitorComponent::WriteReport()
+{
+	UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+
+	const double Now = FPlatformTime::Seconds();
+	const double Elapsed = FMath::Max(Now - LastReportTime, 0.001);
+	LastReportTime = Now;
+
+	TickTimes.Sort();
+
+	auto Percentile = [this](const float Fraction) -> float
+	{
+		return TickTimes.Num() > 0 ? TickTimes[FMath::Clamp(FMath::CeilToInt(Fraction * TickTimes.Num()) - 1, 0, TickTimes.Num() - 1)] : 0.f;
+	};
+
+	const float P50 = Percentile(0.5f);
+	const float P90 = Percentile(0.9f);
+	const float P99 = Percentile(0.99f);
+	const float Max = TickTimes.Num() > 0 ? TickTimes.Last() : 0.f;
+
+	const int32 NumPlayers = NetDriver ? NetDriver->ClientConnections.Num() : 0;
+	const FString RowStart = FString::Printf(TEXT("%s,%d,%.3f,%.3f,%.3f,%.3f"), *FDateTime::Now().ToString(), NumPlayers, P50, P90, P99, Max);
+
+	FString Rows;
+
+	if (NetDriver)
+	{
+		for (UNetConnection* Connection : NetDriver->ClientConnections)
+		{
+			const int32* RPCCount = RPCCounts.Find(Connection);
+			const FMoveRecord MoveRecord = MoveRecords.FindRef(Connection);
+
+			Rows += FString::Printf(TEXT("%s,%s,%d,%d,%.2f,%.2f,%.2f,%.3f\n"), *RowStart, *Connection->LowLevelGetRemoteAddress(true),
+				Connection->InBytesPerSecond, Connection->OutBytesPerSecond, (RPCCount ? *RPCCount : 0) / Elapsed,
+				MoveRecord.RPCs / Elapsed, MoveRecord.Moves / Elapsed, MoveRecord.Seconds * 1000.0 / Elapsed);
+		}
+	}
+
+	//keep a row for the window even with nobody connected, so the tick times before the first bot are there too
+	if (Rows.IsEmpty())
+	{
+		Rows = RowStart + TEXT(",,0,0,0,0,0,0\n");
+	}
+
+	FFileHelper::SaveStringToFile(Rows, *ReportPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+
+	UE_LOG(LogTemp, Log, TEXT("Load test: %d players, tick p50 %.2f ms, p90 %.2f ms, p99 %.2f ms, max %.2f ms"), NumPlayers, P50, P90, P99, Max);
+
+	TickTimes.Reset();
+	RPCCounts.Reset();
+	MoveRecords.Reset();
+}
@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "LoadTestMonitorComponent.generated.h"
+
+/**
+ * Records what the server is doing during a bot load test, so bot counts can be matched up with server cost.
+ * Every ReportInterval it writes a row per connection to Saved/LoadTest/ with the player count, server tick time percentiles,
+ * and that connection's bandwidth in and out, gameplay RPC rate, and movement RPCs, moves and server ms spent running them.
+ * Gameplay RPCs are only the server RPCs that call RecordServerRPC, i.e. interaction, inventory and crafting, not movement or engine RPCs.
+ * Does nothing unless the server was started with -SurvivalLoadTest. Lives on the game mode, so it only exists on the server.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class SURVIVALGAME_API ULoadTestMonitorComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	ULoadTestMonitorComponent();
+
+	//Find the load test monitor for the world the object is in. Null on clients
+	static ULoadTestMonitorComponent* Get(const UObject* WorldContextObject);
+
+	//Count a server RPC against the connection that owns Actor. Call from the RPCs _Implementation. Cheap when not load testing
+	static void RecordServerRPC(const AActor* Actor);
+
+	//Count a movement RPC carrying NumMoves moves against the connection that owns Actor, and the time the server took running them
+	static void RecordServerMoves(const AActor* Actor, const double Seconds, const int32 NumMoves);
+
+	//Seconds between report rows
+	UPROPERTY(EditDefaultsOnly, Category = "Load Test", meta = (ClampMin = 1.0))
+	float ReportInterval;
+
+protected:
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	//Server tick time is from the world starting to tick to the end of the frame, so the wait for the next tick isn't counted
+	void OnWorldTickStart(ELevelTick TickType, float DeltaSeconds);
+	void OnEndFrame();
+
+	void WriteReport();
+
+	bool bRecording;
+
+	double TickStartTime;
+
+	//Server tick times in ms since the last report
+	TArray<float> TickTimes;
+
+	//Hand counted gameplay RPCs received from each connection since the last report, movement is in MoveRecords
+	TMap<TWeakObjectPtr<class UNetConnection>, int32> RPCCounts;
+
+	struct FMoveRecord
+	{
+		int32 RPCs = 0;
+		int32 Moves = 0;
+		double Seconds = 0.0;
+	};
+
+	//Movement received from each connection since the last report
+	TMap<TWeakObjectPtr<class UNetConnection>, FMoveRecord> MoveRecords;
+
+	FString ReportPath;
+	double LastReportTime;
+
+	FDelegateHandle WorldTickStartHandle;
+	FDelegateHandle EndFrameHandle;
+
+	FTimerHandle TimerHandle_Report;
+
+};
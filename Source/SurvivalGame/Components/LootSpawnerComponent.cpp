@@ -0,0 +1,471 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LootSpawnerComponent.h"
+#include "SurvivalGame.h"
+#include "World/LootTable.h"
+#include "World/Pickup.h"
+#include "Framework/SurvivalGameStateBase.h"
+#include "Framework/SurvivalTickAudit.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "Algo/UpperBound.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+
+//Everything a worker thread needs to generate one region, copied so the task never reads the component
+struct FLootGenerationRequest
+{
+	int32 RegionIndex;
+	FBox Bounds;
+	int32 ItemCount;
+	//Region seed mixed with the respawn cycle
+	uint32 Seed;
+	TSharedPtr<const FCompiledLootTable, ESPMode::ThreadSafe> LootTable;
+};
+
+ULootSpawnerComponent::ULootSpawnerComponent()
+{
+	//only ticks while there is loot being generated or waiting to spawn
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	SpawnBatchSize = 200;
+	RegionActivationInterval = 1.f;
+	SpawnQueueHead = 0;
+
+	RarityWeights.Add(EItemRarity::IR_Common, 60.f);
+	RarityWeights.Add(EItemRarity::IR_Uncommon, 25.f);
+	RarityWeights.Add(EItemRarity::IR_Rare, 10.f);
+	RarityWeights.Add(EItemRarity::IR_VeryRare, 4.f);
+	RarityWeights.Add(EItemRarity::IR_Legendary, 1.f);
+}
+
+void ULootSpawnerComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	RegionStates.SetNum(Regions.Num());
+
+	//all the regions go into one task so they share the worker threads
+	TArray<FLootGenerationRequest> Requests;
+
+	for (int32 RegionIndex = 0; RegionIndex < Regions.Num(); ++RegionIndex)
+	{
+		FLootGenerationRequest Request;
+		if (MakeGenerationRequest(RegionIndex, Request))
+		{
+			Requests.Add(Request);
+		}
+
+		if (Regions[RegionIndex].RespawnInterval > 0.f)
+		{
+			FTimerDelegate RespawnDelegate = FTimerDelegate::CreateUObject(this, &ULootSpawnerComponent::SpawnRegion, RegionIndex);
+			GetWorld()->GetTimerManager().SetTimer(RegionStates[RegionIndex].TimerHandle_Respawn, RespawnDelegate, Regions[RegionIndex].RespawnInterval, true);
+		}
+	}
+
+	LaunchGeneration(MoveTemp(Requests));
+
+	GetWorld()->GetTimerManager().SetTimer(TimerHandle_RegionActivation, this, &ULootSpawnerComponent::UpdateRegionActivation, RegionActivationInterval, true);
+}
+
+void ULootSpawnerComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	//tasks trace against the world, so they must finish before it goes away
+	for (FPendingGeneration& Pending : PendingGeneration)
+	{
+		Pending.Task.Wait();
+	}
+
+	PendingGeneration.Empty();
+	GetWorld()->GetTimerManager().ClearAllTimersForObject(this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ULootSpawnerComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	SURVIVAL_TICK_AUDIT_SCOPE();
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	CollectFinishedGeneration();
+	SpawnQueuedPickups();
+
+	//nothing left to do, stop ticking until the next respawn
+	if (PendingGeneration.Num() == 0 && SpawnQueueHead >= SpawnQueue.Num())
+	{
+		SpawnQueue.Reset();
+		SpawnQueueHead = 0;
+		SetComponentTickEnabled(false);
+	}
+}
+
+void ULootSpawnerComponent::SpawnRegion(const int32 RegionIndex)
+{
+	FLootGenerationRequest Request;
+	if (MakeGenerationRequest(RegionIndex, Request))
+	{
+		TArray<FLootGenerationRequest> Requests;
+		Requests.Add(Request);
+		LaunchGeneration(MoveTemp(Requests));
+	}
+}
+
+bool ULootSpawnerComponent::MakeGenerationRequest(const int32 RegionIndex, FLootGenerationRequest& OutRequest)
+{
+	if (!Regions.IsValidIndex(RegionIndex) || !RegionStates.IsValidIndex(RegionIndex) || !PickupClass)
+	{
+		return false;
+	}
+
+	const FLootRegion& Region = Regions[RegionIndex];
+	FRegionState& State = RegionStates[RegionIndex];
+
+	//forget about pickups that have been taken or despawned since last time
+	State.Pickups.RemoveAll([](const TWeakObjectPtr<APickup>& Pickup) { return !Pickup.IsValid(); });
+
+	const int32 MissingCount = Region.ItemCount - State.Pickups.Num() - State.Dormant.Num() - State.PendingCount;
+
+	if (MissingCount <= 0 || !Region.Bounds.IsValid)
+	{
+		return false;
+	}
+
+	TSharedPtr<const FCompiledLootTable, ESPMode::ThreadSafe> LootTable = GetCompiledLootTable(Region.LootTable);
+
+	if (LootTable->AliasTable.IsEmpty())
+	{
+		return false;
+	}
+
+	OutRequest.RegionIndex = RegionIndex;
+	OutRequest.Bounds = Region.Bounds;
+	OutRequest.ItemCount = MissingCount;
+	OutRequest.Seed = HashCombine(GetTypeHash(Region.Seed), GetTypeHash(State.Cycle));
+	OutRequest.LootTable = LootTable;
+
+	State.PendingCount += MissingCount;
+	++State.Cycle;
+
+	return true;
+}
+
+void ULootSpawnerComponent::LaunchGeneration(TArray<FLootGenerationRequest>&& Requests)
+{
+	if (Requests.Num() == 0)
+	{
+		return;
+	}
+
+	FPendingGeneration& Pending = PendingGeneration.AddDefaulted_GetRef();
+	Pending.Placements = MakeShared<TArray<FLootPlacement>, ESPMode::ThreadSafe>();
+
+	const UWorld* World = GetWorld();
+	TSharedPtr<TArray<FLootPlacement>, ESPMode::ThreadSafe> Placements = Pending.Placements;
+
+	Pending.Task = Async(EAsyncExecution::ThreadPool, [World, Requests = MoveTemp(Requests), Placements]()
+	{
+		GeneratePlacements(World, Requests, *Placements);
+	});
+
+	SetComponentTickEnabled(true);
+}
+
+void ULootSpawnerComponent::GeneratePlacements(const UWorld* World, const TArray<FLootGenerationRequest>& Requests, TArray<FLootPlacement>& OutPlacements)
+{
+	//flatten every region into one list of placements, so a single big region is spread over the threads as well
+	TArray<int32> FirstPlacement;
+	int32 NumPlacements = 0;
+
+	for (const FLootGenerationRequest& Request : Requests)
+	{
+		FirstPlacement.Add(NumPlacements);
+		NumPlacements += Request.ItemCount;
+	}
+
+	OutPlacements.SetNum(NumPlacements);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(LootPlacement), false);
+	const FCollisionObjectQueryParams ObjectParams(ECC_WorldStatic);
+
+	ParallelFor(NumPlacements, [&](int32 PlacementIndex)
+	{
+		const int32 RequestIndex = Algo::UpperBound(FirstPlacement, PlacementIndex) - 1;
+		const FLootGenerationRequest& Request = Requests[RequestIndex];
+
+		FLootPlacement& Placement = OutPlacements[PlacementIndex];
+		Placement.RegionIndex = Request.RegionIndex;
+		Placement.Item = nullptr;
+
+		//every placement gets its own stream, so it doesn't matter which thread gets to it or in what order
+		const FRandomStream Stream((int32)HashCombine(Request.Seed, (uint32)(PlacementIndex - FirstPlacement[RequestIndex])));
+
+		int32 Quantity = 0;
+		const FCompiledLootTable::FEntry* Entry = Request.LootTable->Sample(Stream, Quantity);
+
+		const float X = Stream.FRandRange(Request.Bounds.Min.X, Request.Bounds.Max.X);
+		const float Y = Stream.FRandRange(Request.Bounds.Min.Y, Request.Bounds.Max.Y);
+		const float Yaw = Stream.FRandRange(0.f, 360.f);
+
+		const FVector TraceStart(X, Y, Request.Bounds.Max.Z);
+		const FVector TraceEnd(X, Y, Request.Bounds.Min.Z);
+		FHitResult TraceHit;
+
+		//scene queries take a read lock, so they're safe to run from the worker threads
+		if (Entry && World->LineTraceSingleByObjectType(TraceHit, TraceStart, TraceEnd, ObjectParams, QueryParams))
+		{
+			const FRotator Rotation = FRotationMatrix::MakeFromZX(TraceHit.ImpactNormal, FRotator(0.f, Yaw, 0.f).Vector()).Rotator();
+
+			Placement.Item = Entry->Item;
+			Placement.Quantity = Quantity;
+			Placement.Transform = FTransform(Rotation, TraceHit.ImpactPoint);
+		}
+	});
+}
+
+void ULootSpawnerComponent::CollectFinishedGeneration()
+{
+	//oldest first, so spawn order matches request order
+	for (int32 i = 0; i < PendingGeneration.Num();)
+	{
+		if (PendingGeneration[i].Task.IsReady())
+		{
+			SpawnQueue.Append(MoveTemp(*PendingGeneration[i].Placements));
+			PendingGeneration.RemoveAt(i);
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+void ULootSpawnerComponent::SpawnQueuedPickups()
+{
+	SURVIVAL_LLM_SCOPE(Pickups);
+
+	UWorld* World = GetWorld();
+	int32 NumSpawned = 0;
+
+	while (SpawnQueueHead < SpawnQueue.Num() && NumSpawned < SpawnBatchSize)
+	{
+		const FLootPlacement& Placement = SpawnQueue[SpawnQueueHead++];
+		FRegionState& State = RegionStates[Placement.RegionIndex];
+
+		--State.PendingCount;
+
+		//couldnt find ground for this one, it'll be retried on the next respawn
+		if (!Placement.Item)
+		{
+			continue;
+		}
+
+		//no one's near enough to see it, so it stays a placement until someone is
+		if (!State.bActive)
+		{
+			State.Dormant.Add(Placement);
+			State.bBaselineDirty = true;
+			continue;
+		}
+
+		int32 Quantity = Placement.Quantity;
+		float NextDecayTime = Placement.NextDecayTime;
+
+		//dormant loot keeps rotting, so take off every decay it missed while nobody was around
+		const UItem* ItemDefaults = Placement.Item->GetDefaultObject<UItem>();
+
+		if (NextDecayTime > 0.f && ItemDefaults->DecayInterval > 0.f && NextDecayTime <= World->GetTimeSeconds())
+		{
+			const int32 NumMissed = FMath::FloorToInt((World->GetTimeSeconds() - NextDecayTime) / ItemDefaults->DecayInterval) + 1;
+			Quantity -= NumMissed * ItemDefaults->DecayAmount;
+			NextDecayTime += NumMissed * ItemDefaults->DecayInterval;
+
+			if (Quantity <= 0)
+			{
+				State.bBaselineDirty = true;
+				continue;
+			}
+		}
+
+		//deferred so the item is in place before the pickup begins play and replicates
+		if (APickup* Pickup = World->SpawnActorDeferred<APickup>(PickupClass, Placement.Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn))
+		{
+			//spawned loot stays until it's taken or its region goes dormant, it isn't a drop
+			Pickup->bIgnoreDespawnTime = true;
+			Pickup->InitializePickup(Placement.Item, Quantity, NextDecayTime);
+			Pickup->FinishSpawning(Placement.Transform);
+
+			State.Pickups.Add(Pickup);
+			State.bBaselineDirty = true;
+		}
+
+		++NumSpawned;
+	}
+}
+
+void ULootSpawnerComponent::UpdateRegionActivation()
+{
+	ASurvivalGameStateBase* SurvivalGameState = GetWorld()->GetGameState<ASurvivalGameStateBase>();
+
+	if (!SurvivalGameState)
+	{
+		return;
+	}
+
+	TArray<FVector, TInlineAllocator<16>> PlayerLocations;
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (APlayerController* PC = It->Get())
+		{
+			if (APawn* Pawn = PC->GetPawn())
+			{
+				PlayerLocations.Add(Pawn->GetActorLocation());
+			}
+		}
+	}
+
+	const float ActivationDistanceSq = FMath::Square(SurvivalGameState->LootActivationDistance);
+	const float DeactivationDistanceSq = FMath::Square(SurvivalGameState->LootActivationDistance + SurvivalGameState->LootDeactivationMargin);
+
+	for (int32 RegionIndex = 0; RegionIndex < RegionStates.Num(); ++RegionIndex)
+	{
+		FRegionState& State = RegionStates[RegionIndex];
+
+		//pickups that got taken or despawned since last time
+		if (State.Pickups.RemoveAll([](const TWeakObjectPtr<APickup>& Pickup) { return !Pickup.IsValid(); }) > 0)
+		{
+			State.bBaselineDirty = true;
+		}
+
+		float ClosestDistanceSq = MAX_flt;
+
+		for (const FVector& PlayerLocation : PlayerLocations)
+		{
+			ClosestDistanceSq = FMath::Min(ClosestDistanceSq, Regions[RegionIndex].Bounds.ComputeSquaredDistanceToPoint(PlayerLocation));
+		}
+
+		if (!State.bActive && ClosestDistanceSq <= ActivationDistanceSq)
+		{
+			ActivateRegion(RegionIndex);
+		}
+		else if (State.bActive && ClosestDistanceSq > DeactivationDistanceSq)
+		{
+			DeactivateRegion(RegionIndex);
+		}
+
+		//changes are batched up to once per pass, a region being looted doesnt rebuild its baseline for every pickup taken
+		if (State.bBaselineDirty)
+		{
+			UpdateRegionBaseline(RegionIndex);
+		}
+	}
+}
+
+void ULootSpawnerComponent::ActivateRegion(const int32 RegionIndex)
+{
+	FRegionState& State = RegionStates[RegionIndex];
+	State.bActive = true;
+
+	if (State.Dormant.Num() > 0)
+	{
+		//spawned in batches like freshly generated loot
+		State.PendingCount += State.Dormant.Num();
+		SpawnQueue.Append(MoveTemp(State.Dormant));
+		State.Dormant.Reset();
+
+		SetComponentTickEnabled(true);
+	}
+}
+
+void ULootSpawnerComponent::DeactivateRegion(const int32 RegionIndex)
+{
+	FRegionState& State = RegionStates[RegionIndex];
+	State.bActive = false;
+
+	for (const TWeakObjectPtr<APickup>& PickupPtr : State.Pickups)
+	{
+		APickup* Pickup = PickupPtr.Get();
+
+		if (!Pickup)
+		{
+			continue;
+		}
+
+		//keep whatever is left of the stack, it may have been partly taken or decayed
+		if (UItem* Item = Pickup->GetItem())
+		{
+			if (Item->GetQuantity() > 0)
+			{
+				FLootPlacement& Placement = State.Dormant.AddDefaulted_GetRef();
+				Placement.RegionIndex = RegionIndex;
+				Placement.Item = Item->GetClass();
+				Placement.Quantity = Item->GetQuantity();
+				Placement.Transform = Pickup->GetActorTransform();
+				Placement.NextDecayTime = Item->NextDecayTime;
+			}
+		}
+
+		Pickup->Destroy();
+	}
+
+	State.Pickups.Reset();
+	State.bBaselineDirty = true;
+}
+
+void ULootSpawnerComponent::UpdateRegionBaseline(const int32 RegionIndex)
+{
+	ASurvivalGameStateBase* SurvivalGameState = GetWorld()->GetGameState<ASurvivalGameStateBase>();
+	FRegionState& State = RegionStates[RegionIndex];
+
+	if (!SurvivalGameState)
+	{
+		return;
+	}
+
+	TArray<LootBaseline::FEntry> Entries;
+	Entries.Reserve(State.Dormant.Num() + State.Pickups.Num());
+
+	for (const FLootPlacement& Placement : State.Dormant)
+	{
+		Entries.Add({ SurvivalGameState->GetLootItemId(Placement.Item), (uint16)FMath::Clamp(Placement.Quantity, 0, (int32)MAX_uint16), Placement.Transform });
+	}
+
+	for (const TWeakObjectPtr<APickup>& PickupPtr : State.Pickups)
+	{
+		APickup* Pickup = PickupPtr.Get();
+		UItem* Item = Pickup ? Pickup->GetItem() : nullptr;
+
+		if (Item)
+		{
+			Entries.Add({ SurvivalGameState->GetLootItemId(Item->GetClass()), (uint16)FMath::Clamp(Item->GetQuantity(), 0, (int32)MAX_uint16), Pickup->GetActorTransform() });
+		}
+	}
+
+	SurvivalGameState->UpdateLootRegion(RegionIndex, Regions[RegionIndex].Bounds, Entries);
+	State.bBaselineDirty = false;
+}
+
+void ULootSpawnerComponent::GetDormantLoot(const int32 RegionIndex, int32& OutCount, SIZE_T& OutBytes) const
+{
+	OutCount = RegionStates.IsValidIndex(RegionIndex) ? RegionStates[RegionIndex].Dormant.Num() : 0;
+	OutBytes = RegionStates.IsValidIndex(RegionIndex) ? RegionStates[RegionIndex].Dormant.GetAllocatedSize() : 0;
+}
+
+TSharedPtr<const FCompiledLootTable, ESPMode::ThreadSafe> ULootSpawnerComponent::GetCompiledLootTable(const UDataTable* LootTable)
+{
+	if (TSharedPtr<const FCompiledLootTable, ESPMode::ThreadSafe>* CompiledLootTable = CompiledLootTables.Find(LootTable))
+	{
+		return *CompiledLootTable;
+	}
+
+	TSharedPtr<FCompiledLootTable, ESPMode::ThreadSafe> NewLootTable = MakeShared<FCompiledLootTable, ESPMode::ThreadSafe>();
+	NewLootTable->Compile(LootTable, RarityWeights);
+
+	CompiledLootTables.Add(LootTable, NewLootTable);
+	return NewLootTable;
+}
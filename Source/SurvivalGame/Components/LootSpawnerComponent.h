@@ -0,0 +1,173 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Async/Future.h"
+#include "Items/Item.h"
+#include "LootSpawnerComponent.generated.h"
+
+//An area of the map that gets filled with pickups from a loot table
+USTRUCT(BlueprintType)
+struct FLootRegion
+{
+	GENERATED_BODY()
+
+	FLootRegion()
+	{
+		Bounds = FBox(ForceInit);
+		LootTable = nullptr;
+		ItemCount = 0;
+		Seed = 0;
+		RespawnInterval = 0.f;
+	}
+
+	//Pickups are placed on whatever ground is inside this box. Traces go from the top of the box to the bottom
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Loot")
+	FBox Bounds;
+
+	//Data table of FLootTableRow to pick items from
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Loot")
+	class UDataTable* LootTable;
+
+	//How many pickups this region should hold
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Loot", meta = (ClampMin = 0))
+	int32 ItemCount;
+
+	//Same seed, same loot, no matter how many threads generate it
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Loot")
+	int32 Seed;
+
+	//How often in seconds to top the region back up with fresh pickups. Zero means never
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Loot", meta = (ClampMin = 0.0))
+	float RespawnInterval;
+};
+
+//Where to put a pickup and what to put in it. Generated on worker threads, turned into an actor on the game thread.
+//Item is null if nothing could be placed, e.g. the trace missed the ground
+struct FLootPlacement
+{
+	int32 RegionIndex;
+	TSubclassOf<class UItem> Item;
+	int32 Quantity;
+	FTransform Transform;
+
+	//World time the item's next decay is due if it was already decaying when its region went dormant, zero for fresh loot
+	float NextDecayTime = 0.f;
+};
+
+/**
+ * Populates the world with pickups at server start and tops regions up on a respawn cycle. Placements are generated
+ * in the background, in parallel, with every pickup seeded from its region seed, respawn cycle and index so the
+ * result is the same regardless of thread count. Only spawning the actors happens on the game thread, a batch per frame.
+ * Regions nobody is near keep their loot as placements rather than actors, and get spawned when a player comes within the game
+ * states LootActivationDistance. Far away players see the loot from the baselines the game state streams them instead.
+ * Lives on the game mode, so it only exists on the server.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class SURVIVALGAME_API ULootSpawnerComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	ULootSpawnerComponent();
+
+	//The pickup actor spawned for each piece of loot
+	UPROPERTY(EditDefaultsOnly, Category = "Loot")
+	TSubclassOf<class APickup> PickupClass;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Loot")
+	TArray<FLootRegion> Regions;
+
+	//How likely an item of each rarity is to be picked, relative to the others
+	UPROPERTY(EditDefaultsOnly, Category = "Loot")
+	TMap<EItemRarity, float> RarityWeights;
+
+	//The most pickups we'll spawn in a single frame
+	UPROPERTY(EditDefaultsOnly, Category = "Loot", meta = (ClampMin = 1))
+	int32 SpawnBatchSize;
+
+	//How often in seconds we check which regions have players near them
+	UPROPERTY(EditDefaultsOnly, Category = "Loot", meta = (ClampMin = 0.1))
+	float RegionActivationInterval;
+
+	//Generate and spawn the loot for a region, topping it up to its item count
+	UFUNCTION(BlueprintCallable, Category = "Loot")
+	void SpawnRegion(const int32 RegionIndex);
+
+	//A loot table compiled down to an alias table with our rarity weights. Compiled on first use and shared after that
+	TSharedPtr<const struct FCompiledLootTable, ESPMode::ThreadSafe> GetCompiledLootTable(const class UDataTable* LootTable);
+
+	//How much loot a region is holding as placements rather than pickups, and the bytes it takes up. For the memory report
+	void GetDormantLoot(const int32 RegionIndex, int32& OutCount, SIZE_T& OutBytes) const;
+
+protected:
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	//Work out how many pickups a region is missing and fill in a request to generate them. False if it's already full
+	bool MakeGenerationRequest(const int32 RegionIndex, struct FLootGenerationRequest& OutRequest);
+
+	//Kick off a background task generating placements for the requests
+	void LaunchGeneration(TArray<struct FLootGenerationRequest>&& Requests);
+
+	//Trace placements for a set of regions. Runs on worker threads
+	static void GeneratePlacements(const class UWorld* World, const TArray<struct FLootGenerationRequest>& Requests, TArray<FLootPlacement>& OutPlacements);
+
+	//Move finished generation results into the spawn queue
+	void CollectFinishedGeneration();
+
+	void SpawnQueuedPickups();
+
+	//Spawn pickups for regions players have come close to, turn regions everyone has left back into placements, and send the game state
+	//a new baseline for any region whose loot changed
+	void UpdateRegionActivation();
+
+	void ActivateRegion(const int32 RegionIndex);
+	void DeactivateRegion(const int32 RegionIndex);
+
+	//Give the game state what's in a region now, live pickups and placements both, to send to players
+	void UpdateRegionBaseline(const int32 RegionIndex);
+
+	//Generation tasks that are still running in the background, and where they will write their placements
+	struct FPendingGeneration
+	{
+		TFuture<void> Task;
+		TSharedPtr<TArray<FLootPlacement>, ESPMode::ThreadSafe> Placements;
+	};
+
+	TArray<FPendingGeneration> PendingGeneration;
+
+	//Placements waiting to be spawned, we spawn from SpawnQueueHead onwards
+	TArray<FLootPlacement> SpawnQueue;
+	int32 SpawnQueueHead;
+
+	//Loot tables compiled down to alias tables, shared read only with the generation tasks
+	TMap<const class UDataTable*, TSharedPtr<const struct FCompiledLootTable, ESPMode::ThreadSafe>> CompiledLootTables;
+
+	//The pickups alive in each region, and how many times each region has been respawned
+	struct FRegionState
+	{
+		TArray<TWeakObjectPtr<class APickup>> Pickups;
+		//Loot in the region while no one is near enough to need the actors
+		TArray<FLootPlacement> Dormant;
+		//Placements requested or queued that haven't been spawned yet
+		int32 PendingCount = 0;
+		int32 Cycle = 0;
+		//Whether a player is close enough that the loot should be real pickups
+		bool bActive = false;
+		//The loot changed since we last gave the game state a baseline
+		bool bBaselineDirty = false;
+		FTimerHandle TimerHandle_Respawn;
+	};
+
+	TArray<FRegionState> RegionStates;
+
+	FTimerHandle TimerHandle_RegionActivation;
+
+};
@@ -0,0 +1,209 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "StatusEffectComponent.h"
+#include "Framework/SurvivalGameGameModeBase.h"
+#include "Player/SurvivalCharacter.h"
+#include "Framework/SurvivalTickAudit.h"
+#include "Engine/World.h"
+
+UStatusEffectComponent::UStatusEffectComponent()
+{
+	//only ticks while there are effects to run
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	EffectTickInterval = 0.25f;
+}
+
+UStatusEffectComponent* UStatusEffectComponent::Get(const UObject* WorldContextObject)
+{
+	if (UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr)
+	{
+		if (ASurvivalGameGameModeBase* GameMode = World->GetAuthGameMode<ASurvivalGameGameModeBase>())
+		{
+			return GameMode->StatusEffects;
+		}
+	}
+
+	return nullptr;
+}
+
+void UStatusEffectComponent::FEffectList::RemoveAtSwap(const int32 Index)
+{
+	CharacterSlots.RemoveAtSwap(Index, 1, false);
+	Magnitudes.RemoveAtSwap(Index, 1, false);
+	StartTimes.RemoveAtSwap(Index, 1, false);
+	EndTimes.RemoveAtSwap(Index, 1, false);
+}
+
+void UStatusEffectComponent::ApplyEffect(class ASurvivalCharacter* Character, const FStatusEffect& Effect)
+{
+	if (!Character || Effect.Type == EStatusEffectType::SET_MAX || Effect.Duration <= 0.f)
+	{
+		return;
+	}
+
+	const int32 Slot = FindOrAddCharacterSlot(Character);
+	const float CurrentTime = GetWorld()->GetTimeSeconds();
+
+	FEffectList& EffectList = EffectLists[(int32)Effect.Type];
+	EffectList.CharacterSlots.Add(Slot);
+	EffectList.Magnitudes.Add(Effect.Magnitude);
+	EffectList.StartTimes.Add(CurrentTime);
+	EffectList.EndTimes.Add(CurrentTime + Effect.Duration);
+
+	if (!IsComponentTickEnabled())
+	{
+		SetComponentTickInterval(EffectTickInterval);
+		SetComponentTickEnabled(true);
+	}
+}
+
+void UStatusEffectComponent::ApplyEffects(class ASurvivalCharacter* Character, const TArray<FStatusEffect>& Effects)
+{
+	for (const FStatusEffect& Effect : Effects)
+	{
+		ApplyEffect(Character, Effect);
+	}
+}
+
+void UStatusEffectComponent::ClearEffects(class ASurvivalCharacter* Character)
+{
+	int32 Slot = INDEX_NONE;
+	if (!CharacterSlots.RemoveAndCopyValue(Character, Slot))
+	{
+		return;
+	}
+
+	for (FEffectList& EffectList : EffectLists)
+	{
+		for (int32 i = EffectList.Num() - 1; i >= 0; --i)
+		{
+			if (EffectList.CharacterSlots[i] == Slot)
+			{
+				EffectList.RemoveAtSwap(i);
+			}
+		}
+	}
+
+	//don't leave them sped up or slowed down by effects that aren't there anymore
+	if (Character)
+	{
+		Character->ApplyStatusEffects(0.f, 0.f, 1.f);
+	}
+
+	Characters[Slot] = nullptr;
+	FreeCharacterSlots.Add(Slot);
+}
+
+int32 UStatusEffectComponent::FindOrAddCharacterSlot(class ASurvivalCharacter* Character)
+{
+	if (const int32* Slot = CharacterSlots.Find(Character))
+	{
+		return *Slot;
+	}
+
+	int32 Slot = INDEX_NONE;
+
+	if (FreeCharacterSlots.Num() > 0)
+	{
+		Slot = FreeCharacterSlots.Pop(false);
+		Characters[Slot] = Character;
+	}
+	else
+	{
+		Slot = Characters.Add(Character);
+		HealthAmounts.AddZeroed();
+		HungerAmounts.AddZeroed();
+		SpeedMultipliers.AddZeroed();
+		EffectCounts.AddZeroed();
+	}
+
+	CharacterSlots.Add(Character, Slot);
+
+	return Slot;
+}
+
+void UStatusEffectComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	SURVIVAL_TICK_AUDIT_SCOPE();
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	const float CurrentTime = GetWorld()->GetTimeSeconds();
+	const float PassStartTime = CurrentTime - DeltaTime;
+	const int32 NumSlots = Characters.Num();
+
+	//start every character from no effects, then add up everything that's on them
+	FMemory::Memzero(HealthAmounts.GetData(), NumSlots * sizeof(float));
+	FMemory::Memzero(HungerAmounts.GetData(), NumSlots * sizeof(float));
+	FMemory::Memzero(EffectCounts.GetData(), NumSlots * sizeof(int32));
+	for (float& SpeedMultiplier : SpeedMultipliers)
+	{
+		SpeedMultiplier = 1.f;
+	}
+
+	//one tight loop per effect type, so each loop only touches the arrays it needs
+	const auto AccumulateEffects = [&](FEffectList& EffectList, TArray<float>& Totals, const bool bMultiply)
+	{
+		for (int32 i = EffectList.Num() - 1; i >= 0; --i)
+		{
+			const int32 Slot = EffectList.CharacterSlots[i];
+			const bool bExpired = EffectList.EndTimes[i] <= CurrentTime;
+
+			//a multiplier is a state rather than an amount over time, so one that ran out stops applying straight away
+			if (bMultiply)
+			{
+				if (!bExpired)
+				{
+					Totals[Slot] *= EffectList.Magnitudes[i];
+				}
+			}
+			//a rate only counts for the part of this pass it was running. One that started or ran out partway through gets that part,
+			//so a 10 second effect gives exactly its full amount however the passes line up with it
+			else
+			{
+				const float ActiveTime = FMath::Min(EffectList.EndTimes[i], CurrentTime) - FMath::Max(EffectList.StartTimes[i], PassStartTime);
+				Totals[Slot] += EffectList.Magnitudes[i] * FMath::Max(ActiveTime, 0.f);
+			}
+
+			if (bExpired)
+			{
+				EffectList.RemoveAtSwap(i);
+			}
+			else
+			{
+				++EffectCounts[Slot];
+			}
+		}
+	};
+
+	AccumulateEffects(EffectLists[(int32)EStatusEffectType::SET_Health], HealthAmounts, false);
+	AccumulateEffects(EffectLists[(int32)EStatusEffectType::SET_Hunger], HungerAmounts, false);
+	AccumulateEffects(EffectLists[(int32)EStatusEffectType::SET_Speed], SpeedMultipliers, true);
+
+	//each character is written once with the totals, and only replicates if that actually changed something
+	for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+	{
+		ASurvivalCharacter* Character = Characters[Slot].Get();
+
+		if (!Character)
+		{
+			continue;
+		}
+
+		Character->ApplyStatusEffects(HealthAmounts[Slot], HungerAmounts[Slot], SpeedMultipliers[Slot]);
+
+		//that was their last effect running out, free up the slot. Their speed was just put back to 1 above
+		if (EffectCounts[Slot] == 0)
+		{
+			ClearEffects(Character);
+		}
+	}
+
+	if (CharacterSlots.Num() == 0)
+	{
+		SetComponentTickEnabled(false);
+	}
+}
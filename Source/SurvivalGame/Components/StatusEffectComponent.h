@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "StatusEffectComponent.generated.h"
+
+UENUM(BlueprintType)
+enum class EStatusEffectType : uint8
+{
+	//Magnitude is health gained per second, negative for poison and bleeding
+	SET_Health UMETA(DisplayName = "Health Over Time"),
+	//Magnitude is hunger restored per second
+	SET_Hunger UMETA(DisplayName = "Hunger Over Time"),
+	//Magnitude multiplies walk speed, several boosts multiply together
+	SET_Speed UMETA(DisplayName = "Speed Multiplier"),
+
+	SET_MAX UMETA(Hidden)
+};
+
+//One effect a consumable puts on whoever uses it
+USTRUCT(BlueprintType)
+struct FStatusEffect
+{
+	GENERATED_BODY()
+
+	FStatusEffect()
+	{
+		Type = EStatusEffectType::SET_Health;
+		Magnitude = 1.f;
+		Duration = 10.f;
+	}
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Status Effect")
+	EStatusEffectType Type;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Status Effect")
+	float Magnitude;
+
+	//How long in seconds the effect lasts
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Status Effect", meta = (ClampMin = 0.0))
+	float Duration;
+};
+
+/**
+ * Runs every active status effect in the world, instead of each one having its own timer or ticking object.
+ * Effects are kept in flat arrays, one set per effect type, and applied in a single pass every EffectTickInterval. All of a character's
+ * effects are added up first, then applied to the character once, so each character's stats are written at most once per pass,
+ * and only when they actually changed.
+ * Lives on the game mode, so it only exists on the server.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class SURVIVALGAME_API UStatusEffectComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UStatusEffectComponent();
+
+	//Find the status effect manager for the world the object is in. Null on clients
+	static UStatusEffectComponent* Get(const UObject* WorldContextObject);
+
+	//How often in seconds effects are applied. Effects over time are scaled by the real time between passes, so this only changes how smooth they are
+	UPROPERTY(EditDefaultsOnly, Category = "Status Effects", meta = (ClampMin = 0.0))
+	float EffectTickInterval;
+
+	//Start an effect on a character
+	UFUNCTION(BlueprintCallable, Category = "Status Effects")
+	void ApplyEffect(class ASurvivalCharacter* Character, const FStatusEffect& Effect);
+
+	void ApplyEffects(class ASurvivalCharacter* Character, const TArray<FStatusEffect>& Effects);
+
+	//Remove every effect on a character, e.g. when they leave, and put their speed back to normal
+	void ClearEffects(class ASurvivalCharacter* Character);
+
+protected:
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	//Every active effect of one type, as parallel arrays
+	struct FEffectList
+	{
+		//Index into Characters of who the effect is on
+		TArray<int32> CharacterSlots;
+		TArray<float> Magnitudes;
+		TArray<float> StartTimes;
+		TArray<float> EndTimes;
+
+		void RemoveAtSwap(const int32 Index);
+		FORCEINLINE int32 Num() const { return CharacterSlots.Num(); }
+	};
+
+	FEffectList EffectLists[(int32)EStatusEffectType::SET_MAX];
+
+	//Get the slot for a character, giving them one if they don't have one yet
+	int32 FindOrAddCharacterSlot(class ASurvivalCharacter* Character);
+
+	//Characters with effects on them. Slots are reused once a character has no effects left
+	TArray<TWeakObjectPtr<class ASurvivalCharacter>> Characters;
+	TMap<class ASurvivalCharacter*, int32> CharacterSlots;
+	TArray<int32> FreeCharacterSlots;
+
+	//Per character totals for the current pass, indexed by slot. Health and hunger are the amounts to add this pass
+	TArray<float> HealthAmounts;
+	TArray<float> HungerAmounts;
+	TArray<float> SpeedMultipliers;
+	TArray<int32> EffectCounts;
+
+};
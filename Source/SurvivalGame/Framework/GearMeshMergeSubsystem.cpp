@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GearMeshMergeSubsystem.h"
+#include "Components/GearMeshMergeComponent.h"
+#include "Engine/GameInstance.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/World.h"
+#include "SkeletalMeshMerge.h"
+#include "TimerManager.h"
+
+UGearMeshMergeSubsystem* UGearMeshMergeSubsystem::Get(const UObject* WorldContextObject)
+{
+	if (UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr)
+	{
+		if (UGameInstance* GameInstance = World->GetGameInstance())
+		{
+			return GameInstance->GetSubsystem<UGearMeshMergeSubsystem>();
+		}
+	}
+
+	return nullptr;
+}
+
+bool UGearMeshMergeSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return !IsRunningDedicatedServer();
+}
+
+void UGearMeshMergeSubsystem::Deinitialize()
+{
+	GetGameInstance()->GetTimerManager().ClearAllTimersForObject(this);
+	MergeQueue.Empty();
+	MergedMeshCache.Empty();
+
+	Super::Deinitialize();
+}
+
+UGearMeshMergeSubsystem::FMergeKey UGearMeshMergeSubsystem::MakeMergeKey(const TArray<USkeletalMesh*>& SourceMeshes)
+{
+	FMergeKey Key;
+
+	for (USkeletalMesh* Mesh : SourceMeshes)
+	{
+		Key.Meshes.Add(FObjectKey(Mesh));
+	}
+
+	return Key;
+}
+
+USkeletalMesh* UGearMeshMergeSubsystem::FindMergedMesh(const TArray<USkeletalMesh*>& SourceMeshes)
+{
+	return MergedMeshCache.FindRef(MakeMergeKey(SourceMeshes)).Get();
+}
+
+USkeletalMesh* UGearMeshMergeSubsystem::CreateMergedMesh(const TArray<USkeletalMesh*>& SourceMeshes, const UObject* Requester)
+{
+	if (SourceMeshes.Num() == 0 || !SourceMeshes[0])
+	{
+		return nullptr;
+	}
+
+	//merged meshes nobody wears anymore get garbage collected, drop their entries so the cache doesn't keep growing
+	for (auto It = MergedMeshCache.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	USkeletalMesh* NewMergedMesh = NewObject<USkeletalMesh>(GetTransientPackage(), NAME_None, RF_Transient);
+	NewMergedMesh->Skeleton = SourceMeshes[0]->Skeleton;
+
+	TArray<FSkelMeshMergeSectionMapping> SectionMappings;
+	FSkeletalMeshMerge Merger(NewMergedMesh, SourceMeshes, SectionMappings, 0);
+
+	if (!Merger.DoMerge())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Failed to merge gear meshes for %s, falling back to separate components"), *GetNameSafe(Requester));
+		return nullptr;
+	}
+
+	MergedMeshCache.Add(MakeMergeKey(SourceMeshes), NewMergedMesh);
+	return NewMergedMesh;
+}
+
+void UGearMeshMergeSubsystem::QueueMerge(UGearMeshMergeComponent* Component)
+{
+	if (!Component || MergeQueue.Contains(Component))
+	{
+		return;
+	}
+
+	MergeQueue.Add(Component);
+
+	if (MergeQueue.Num() == 1)
+	{
+		GetGameInstance()->GetTimerManager().SetTimerForNextTick(this, &UGearMeshMergeSubsystem::ProcessMergeQueue);
+	}
+}
+
+void UGearMeshMergeSubsystem::ProcessMergeQueue()
+{
+	//components that went away, changed their mind or found their combination already merged don't use up this frame's merge
+	while (MergeQueue.Num() > 0)
+	{
+		UGearMeshMergeComponent* Component = MergeQueue[0].Get();
+		MergeQueue.RemoveAt(0, 1, false);
+
+		if (Component && Component->MergeQueuedGear())
+		{
+			break;
+		}
+	}
+
+	if (MergeQueue.Num() > 0)
+	{
+		GetGameInstance()->GetTimerManager().SetTimerForNextTick(this, &UGearMeshMergeSubsystem::ProcessMergeQueue);
+	}
+}
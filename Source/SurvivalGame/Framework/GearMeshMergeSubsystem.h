@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "GearMeshMergeSubsystem.generated.h"
+
+/**
+ * Owns the merged gear meshes for a game instance, so characters wearing the same outfit share one mesh without sharing it with
+ * other PIE instances. Merging runs on the game thread and takes long enough to hitch, so merges are queued and done one per frame,
+ * e.g. when a crowd of characters becomes relevant at once. Characters draw their gear separately until it's their turn.
+ * Only exists on clients, the dedicated server never draws gear.
+ */
+UCLASS()
+class SURVIVALGAME_API UGearMeshMergeSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	//Find the merge subsystem for the game instance the object is in. Null on a dedicated server
+	static UGearMeshMergeSubsystem* Get(const UObject* WorldContextObject);
+
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	//The merged mesh for this combination of body and gear if one has been made already
+	class USkeletalMesh* FindMergedMesh(const TArray<class USkeletalMesh*>& SourceMeshes);
+
+	//Merge a combination of body and gear now and cache it. Null if the merge failed
+	class USkeletalMesh* CreateMergedMesh(const TArray<class USkeletalMesh*>& SourceMeshes, const UObject* Requester);
+
+	//Have the component merge its gear once it's its turn
+	void QueueMerge(class UGearMeshMergeComponent* Component);
+
+protected:
+
+	//Identifies a combination of body and gear meshes, in slot order
+	struct FMergeKey
+	{
+		TArray<FObjectKey, TInlineAllocator<8>> Meshes;
+
+		bool operator==(const FMergeKey& Other) const
+		{
+			return Meshes == Other.Meshes;
+		}
+
+		friend uint32 GetTypeHash(const FMergeKey& Key)
+		{
+			uint32 Hash = 0;
+			for (const FObjectKey& Mesh : Key.Meshes)
+			{
+				Hash = HashCombine(Hash, GetTypeHash(Mesh));
+			}
+			return Hash;
+		}
+	};
+
+	static FMergeKey MakeMergeKey(const TArray<class USkeletalMesh*>& SourceMeshes);
+
+	//Let the front of the queue merge, until one of them actually had to
+	void ProcessMergeQueue();
+
+	//Merged meshes shared between every character wearing the same combination. Weak so unused combinations get garbage collected
+	TMap<FMergeKey, TWeakObjectPtr<class USkeletalMesh>> MergedMeshCache;
+
+	//Components waiting for their turn to merge, in the order they asked
+	TArray<TWeakObjectPtr<class UGearMeshMergeComponent>> MergeQueue;
+
+};
@@ -0,0 +1,387 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InteractionReplay.h"
+#include "Framework/SurvivalPerfCheck.h"
+#include "Player/SurvivalCharacter.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/GameModeBase.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+
+//stop listing mismatches after this many, the rest usually follow on from the first
+static const int32 MaxLoggedMismatches = 10;
+
+static TWeakObjectPtr<USurvivalInteractionReplay> ActiveReplay;
+
+USurvivalInteractionReplay::USurvivalInteractionReplay()
+{
+	FrameTolerance = 2;
+	RegressionThreshold = 10.f;
+	bExitWhenDone = false;
+
+	CurrentFrame = 0;
+	bPreviousUseFixedTimeStep = false;
+	PreviousFixedDeltaTime = 0.0;
+	bRunning = false;
+	bStopped = false;
+}
+
+bool USurvivalInteractionReplay::Start(UWorld* InWorld, const FString& SessionPath)
+{
+	World = InWorld;
+
+	//interactions only finish on the server
+	if (!InWorld || !InWorld->GetAuthGameMode())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Interaction replays need to be run on the server or in standalone."));
+		return false;
+	}
+
+	if (!InteractionSession::Load(SessionPath, Session) || Session.Frames.Num() == 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Couldn't load an interaction session from %s"), *SessionPath);
+		return false;
+	}
+
+	SessionName = FPaths::GetBaseFilename(SessionPath);
+
+	FString MapName = InWorld->GetMapName();
+	MapName.RemoveFromStart(InWorld->StreamingLevelsPrefix);
+
+	if (MapName != Session.MapName)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Interaction session %s was recorded on %s, not %s. Expect the events not to match"), *SessionName, *Session.MapName, *MapName);
+	}
+
+	TSubclassOf<APawn> DefaultPawnClass = InWorld->GetAuthGameMode()->DefaultPawnClass;
+	TSubclassOf<ASurvivalCharacter> CharacterClass = DefaultPawnClass && DefaultPawnClass->IsChildOf(ASurvivalCharacter::StaticClass()) ? *DefaultPawnClass : ASurvivalCharacter::StaticClass();
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	const InteractionSession::FFrame& FirstFrame = Session.Frames[0];
+	ASurvivalCharacter* ReplayCharacter = InWorld->SpawnActor<ASurvivalCharacter>(CharacterClass, FTransform(FirstFrame.ViewLocation), SpawnParams);
+
+	if (!ReplayCharacter)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Couldn't spawn a character to replay %s with"), *SessionName);
+		return false;
+	}
+
+	//it's just a view that moves around, it shouldn't fall or bump into anything
+	ReplayCharacter->SetActorEnableCollision(false);
+	ReplayCharacter->GetCharacterMovement()->SetMovementMode(MOVE_Flying);
+
+	//the interaction check needs a controller
+	ReplayCharacter->SpawnDefaultController();
+	ReplayCharacter->SetInteractionViewOverride(FirstFrame.ViewLocation, FirstFrame.ViewRotation, (FirstFrame.Flags & InteractionSession::FF_Gamepad) != 0);
+	ReplayCharacter->OnInteractionEvent.AddUObject(this, &USurvivalInteractionReplay::OnInteractionEvent);
+
+	Character = ReplayCharacter;
+
+	//step world time by exactly what the recording did, so timers like the interact timer go off in the same frame
+	bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+	PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(FMath::Max(FirstFrame.DeltaTime, KINDA_SMALL_NUMBER));
+
+	ReplayedEvents.Reset();
+	FrameTimes.Reset(Session.Frames.Num());
+	CurrentFrame = 0;
+
+	bRunning = true;
+	AddToRoot();
+
+	UE_LOG(LogTemp, Log, TEXT("Replaying %d frames of interaction session %s"), Session.Frames.Num(), *SessionName);
+
+	return true;
+}
+
+bool USurvivalInteractionReplay::IsTickable() const
+{
+	return bRunning && !HasAnyFlags(RF_ClassDefaultObject);
+}
+
+TStatId USurvivalInteractionReplay::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USurvivalInteractionReplay, STATGROUP_Tickables);
+}
+
+void USurvivalInteractionReplay::Tick(float DeltaTime)
+{
+	if (!World.IsValid() || !Character.IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Interaction replay world or character went away, stopping."));
+		bStopped = true;
+		Finish();
+		return;
+	}
+
+	if (CurrentFrame >= Session.Frames.Num())
+	{
+		Finish();
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	ReplayFrame(Session.Frames[CurrentFrame]);
+	FrameTimes.Add((FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+	//the next engine frame is the next recorded one
+	if (++CurrentFrame < Session.Frames.Num())
+	{
+		FApp::SetFixedDeltaTime(FMath::Max(Session.Frames[CurrentFrame].DeltaTime, KINDA_SMALL_NUMBER));
+	}
+}
+
+void USurvivalInteractionReplay::ReplayFrame(const InteractionSession::FFrame& Frame)
+{
+	ASurvivalCharacter* ReplayCharacter = Character.Get();
+
+	ReplayCharacter->SetActorLocation(Frame.ViewLocation);
+	ReplayCharacter->SetInteractionViewOverride(Frame.ViewLocation, Frame.ViewRotation, (Frame.Flags & InteractionSession::FF_Gamepad) != 0);
+
+	//same order as a real frame: the controller handles the key, then the character ticks and checks
+	if (Frame.Flags & InteractionSession::FF_InteractPressed)
+	{
+		ReplayCharacter->BeginInteract();
+	}
+
+	if (Frame.Flags & InteractionSession::FF_InteractReleased)
+	{
+		ReplayCharacter->EndInteract();
+	}
+
+	if (Frame.Flags & InteractionSession::FF_Check)
+	{
+		ReplayCharacter->PerformInteractionCheck();
+	}
+}
+
+void USurvivalInteractionReplay::OnInteractionEvent(const EInteractionEvent Event, UInteractionComponent* Interactable)
+{
+	InteractionSession::FEvent& NewEvent = ReplayedEvents.AddDefaulted_GetRef();
+	NewEvent.Frame = CurrentFrame;
+	NewEvent.Type = Event;
+	NewEvent.Target = InteractionSession::GetTargetName(Interactable);
+}
+
+void USurvivalInteractionReplay::Finish()
+{
+	bRunning = false;
+	RemoveFromRoot();
+
+	FApp::SetUseFixedTimeStep(bPreviousUseFixedTimeStep);
+	FApp::SetFixedDeltaTime(PreviousFixedDeltaTime);
+
+	if (ASurvivalCharacter* ReplayCharacter = Character.Get())
+	{
+		ReplayCharacter->OnInteractionEvent.RemoveAll(this);
+
+		if (AController* Controller = ReplayCharacter->GetController())
+		{
+			Controller->Destroy();
+		}
+
+		ReplayCharacter->Destroy();
+	}
+
+	const int32 NumMismatches = CompareEvents();
+	const FTimingSummary Timing = SummarizeFrameTimes();
+
+	//anything that means we couldn't say the replay passed fails the run, so a ci job quitting with -ExitAfterReplay fails too
+	bool bFailed = bStopped;
+
+	if (SaveResults(NumMismatches, Timing))
+	{
+		UE_LOG(LogTemp, Log, TEXT("Interaction replay results written to %s"), *OutputPath);
+	}
+	else
+	{
+		bFailed = true;
+	}
+
+	if (NumMismatches > 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Interaction replay %s failed, %d of %d events didn't match the recording"), *SessionName, NumMismatches, Session.Events.Num());
+		bFailed = true;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Interaction replay %s: %d frames, %.4f ms average, %.4f ms p99, %.4f ms max in the interaction path"),
+		*SessionName, FrameTimes.Num(), Timing.AverageMs, Timing.P99Ms, Timing.MaxMs);
+
+	double BaselineAverageMs = 0.0;
+	double BaselineP99Ms = 0.0;
+
+	if (LoadBaseline(BaselineAverageMs, BaselineP99Ms))
+	{
+		SurvivalPerfCheck::FRegressionCheck Check(TEXT("Interaction replay"), RegressionThreshold);
+		Check.CheckMetric(SessionName, TEXT("AverageMs"), Timing.AverageMs, BaselineAverageMs, SurvivalPerfCheck::MinCallRegressionMs);
+		Check.CheckMetric(SessionName, TEXT("P99Ms"), Timing.P99Ms, BaselineP99Ms, SurvivalPerfCheck::MinCallRegressionMs);
+
+		if (Check.NumRegressions > 0)
+		{
+			bFailed = true;
+		}
+		else
+		{
+			UE_LOG(LogTemp, Log, TEXT("Interaction replay %s timing passed against %s"), *SessionName, *BaselinePath);
+		}
+	}
+	else if (bExitWhenDone)
+	{
+		//a ci run with nothing to check the timing against hasn't checked it
+		UE_LOG(LogTemp, Error, TEXT("No interaction replay baseline at %s, nothing to compare against."), *BaselinePath);
+		bFailed = true;
+	}
+
+	if (bExitWhenDone)
+	{
+		SurvivalPerfCheck::RequestExit(bFailed);
+	}
+}
+
+int32 USurvivalInteractionReplay::CompareEvents() const
+{
+	int32 NumMismatches = 0;
+	const int32 NumEvents = FMath::Max(Session.Events.Num(), ReplayedEvents.Num());
+
+	//in order, one for one. Once something diverges the rest usually does too, so the first few mismatches are the ones to look at
+	for (int32 i = 0; i < NumEvents; ++i)
+	{
+		const InteractionSession::FEvent* Recorded = Session.Events.IsValidIndex(i) ? &Session.Events[i] : nullptr;
+		const InteractionSession::FEvent* Replayed = ReplayedEvents.IsValidIndex(i) ? &ReplayedEvents[i] : nullptr;
+
+		const bool bMatches = Recorded && Replayed && Recorded->Type == Replayed->Type && Recorded->Target == Replayed->Target
+			&& FMath::Abs(Recorded->Frame - Replayed->Frame) <= FrameTolerance;
+
+		if (bMatches)
+		{
+			continue;
+		}
+
+		if (++NumMismatches <= MaxLoggedMismatches)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Interaction event %d: recorded %s %s at frame %d, replayed %s %s at frame %d"), i,
+				Recorded ? InteractionSession::GetEventName(Recorded->Type) : TEXT("nothing"), Recorded ? *Recorded->Target : TEXT(""), Recorded ? Recorded->Frame : -1,
+				Replayed ? InteractionSession::GetEventName(Replayed->Type) : TEXT("nothing"), Replayed ? *Replayed->Target : TEXT(""), Replayed ? Replayed->Frame : -1);
+		}
+	}
+
+	return NumMismatches;
+}
+
+USurvivalInteractionReplay::FTimingSummary USurvivalInteractionReplay::SummarizeFrameTimes() const
+{
+	FTimingSummary Summary;
+
+	if (FrameTimes.Num() == 0)
+	{
+		return Summary;
+	}
+
+	TArray<double> SortedTimes = FrameTimes;
+	SortedTimes.Sort();
+
+	for (const double FrameTime : SortedTimes)
+	{
+		Summary.TotalMs += FrameTime;
+	}
+
+	Summary.AverageMs = Summary.TotalMs / SortedTimes.Num();
+	Summary.P99Ms = SortedTimes[FMath::Clamp(FMath::CeilToInt(0.99f * SortedTimes.Num()) - 1, 0, SortedTimes.Num() - 1)];
+	Summary.MaxMs = SortedTimes.Last();
+
+	return Summary;
+}
+
+bool USurvivalInteractionReplay::SaveResults(const int32 NumMismatches, const FTimingSummary& Timing) const
+{
+	TSharedRef<FJsonObject> RootObject = MakeShared<FJsonObject>();
+	RootObject->SetStringField(TEXT("Session"), SessionName);
+	RootObject->SetStringField(TEXT("Map"), Session.MapName);
+	RootObject->SetNumberField(TEXT("Frames"), FrameTimes.Num());
+	RootObject->SetNumberField(TEXT("RecordedEvents"), Session.Events.Num());
+	RootObject->SetNumberField(TEXT("ReplayedEvents"), ReplayedEvents.Num());
+	RootObject->SetNumberField(TEXT("MismatchedEvents"), NumMismatches);
+	RootObject->SetNumberField(TEXT("TotalMs"), Timing.TotalMs);
+	RootObject->SetNumberField(TEXT("AverageMs"), Timing.AverageMs);
+	RootObject->SetNumberField(TEXT("P99Ms"), Timing.P99Ms);
+	RootObject->SetNumberField(TEXT("MaxMs"), Timing.MaxMs);
+
+	return SurvivalPerfCheck::SaveJson(RootObject, OutputPath);
+}
+
+bool USurvivalInteractionReplay::LoadBaseline(double& OutAverageMs, double& OutP99Ms) const
+{
+	const TSharedPtr<FJsonObject> RootObject = SurvivalPerfCheck::LoadJson(BaselinePath);
+
+	return RootObject.IsValid() && RootObject->TryGetNumberField(TEXT("AverageMs"), OutAverageMs) && RootObject->TryGetNumberField(TEXT("P99Ms"), OutP99Ms);
+}
+
+static void ReplayInteractions(const TArray<FString>& Args, UWorld* World)
+{
+	if (ActiveReplay.IsValid() && ActiveReplay->IsTickable())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("An interaction replay is already running."));
+		return;
+	}
+
+	USurvivalInteractionReplay* Replay = NewObject<USurvivalInteractionReplay>();
+	Replay->bExitWhenDone = FParse::Param(FCommandLine::Get(), TEXT("ExitAfterReplay"));
+
+	FString SessionNameOrPath;
+
+	for (const FString& Param : SurvivalPerfCheck::GetParams(Args))
+	{
+		FParse::Value(*Param, TEXT("Session="), SessionNameOrPath);
+		FParse::Value(*Param, TEXT("Output="), Replay->OutputPath);
+		FParse::Value(*Param, TEXT("Baseline="), Replay->BaselinePath);
+		FParse::Value(*Param, TEXT("Threshold="), Replay->RegressionThreshold);
+		FParse::Value(*Param, TEXT("Tolerance="), Replay->FrameTolerance);
+	}
+
+	if (SessionNameOrPath.IsEmpty())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Usage: Survival.ReplayInteractions Session=<name or path> [Output=<json>] [Baseline=<json>] [Threshold=<percent>] [Tolerance=<frames>]"));
+
+		if (Replay->bExitWhenDone)
+		{
+			SurvivalPerfCheck::RequestExit(true);
+		}
+
+		return;
+	}
+
+	const FString SessionPath = InteractionSession::GetSessionPath(SessionNameOrPath);
+	const FString SessionName = FPaths::GetBaseFilename(SessionPath);
+
+	if (Replay->OutputPath.IsEmpty())
+	{
+		Replay->OutputPath = FPaths::ProjectSavedDir() / TEXT("InteractionReplays") / SessionName + TEXT(".json");
+	}
+
+	//checked in fixtures keep their baseline results next to the benchmark baseline
+	if (Replay->BaselinePath.IsEmpty())
+	{
+		Replay->BaselinePath = FPaths::ProjectDir() / TEXT("Benchmarks") / TEXT("InteractionReplays") / SessionName + TEXT(".json");
+	}
+
+	Replay->FrameTolerance = FMath::Max(Replay->FrameTolerance, 0);
+
+	ActiveReplay = Replay;
+
+	if (!Replay->Start(World, SessionPath) && Replay->bExitWhenDone)
+	{
+		SurvivalPerfCheck::RequestExit(true);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs ReplayInteractionsCommand(
+	TEXT("Survival.ReplayInteractions"),
+	TEXT("Replays a recorded interaction session and checks its events and timing. Args: Session=<name or path> Output=<json> Baseline=<json> Threshold=<percent> Tolerance=<frames>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ReplayInteractions));
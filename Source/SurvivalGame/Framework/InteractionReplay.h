@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Tickable.h"
+#include "Framework/InteractionSession.h"
+#include "InteractionReplay.generated.h"
+
+/**
+ * Plays a recorded interaction session back on its own character: one recorded frame per frame, with the engine stepping
+ * world time by the recorded frame times so interaction timers finish when they did. Each frame sets the recorded view,
+ * presses or releases interact, and runs the interaction check if one ran in the recording.
+ * At the end the focus and interact events are compared against the recording, and the time spent in the interaction path
+ * per frame is reported, and checked against a baseline if there is one. Results are written as json.
+ *
+ * Started with "Survival.ReplayInteractions Session=<name or path>", on the server or in standalone, on the map it was
+ * recorded on. Headless: -nullrhi -ExecCmds="Survival.ReplayInteractions Session=<name>" -ExitAfterReplay
+ * quits when done, with a non-zero exit code if events didn't match, the timing regressed, or there was no baseline to check against.
+ * Record sessions in standalone to use as fixtures. On a client, things the server decides (a pickup going away) can
+ * happen a few frames later than they will in the replay.
+ */
+UCLASS(Transient)
+class SURVIVALGAME_API USurvivalInteractionReplay : public UObject, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	USurvivalInteractionReplay();
+
+	//Events that happened this many frames apart in the recording and replay still match, the interact timer can land a frame either side
+	int32 FrameTolerance;
+
+	//How much slower than the baseline the interaction path can get, as a percentage, before it counts as a regression
+	float RegressionThreshold;
+
+	FString OutputPath;
+	FString BaselinePath;
+
+	//Quit once the replay is done
+	bool bExitWhenDone;
+
+	//Load the session and start replaying it in World. False if it couldn't be loaded
+	bool Start(UWorld* InWorld, const FString& SessionPath);
+
+	//FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual bool IsTickableWhenPaused() const override { return false; }
+	virtual TStatId GetStatId() const override;
+
+protected:
+
+	void ReplayFrame(const InteractionSession::FFrame& Frame);
+
+	void OnInteractionEvent(const EInteractionEvent Event, class UInteractionComponent* Interactable);
+
+	struct FTimingSummary
+	{
+		double TotalMs = 0.0;
+		double AverageMs = 0.0;
+		double P99Ms = 0.0;
+		double MaxMs = 0.0;
+	};
+
+	void Finish();
+
+	//Match replayed events up with the recorded ones in order. Returns how many didn't match
+	int32 CompareEvents() const;
+
+	FTimingSummary SummarizeFrameTimes() const;
+
+	bool SaveResults(const int32 NumMismatches, const FTimingSummary& Timing) const;
+
+	//The recorded average and p99 interaction time from a baseline results json
+	bool LoadBaseline(double& OutAverageMs, double& OutP99Ms) const;
+
+	TWeakObjectPtr<UWorld> World;
+	TWeakObjectPtr<class ASurvivalCharacter> Character;
+
+	InteractionSession::FSession Session;
+	FString SessionName;
+
+	//Events the replay produced, to compare against Session.Events
+	TArray<InteractionSession::FEvent> ReplayedEvents;
+
+	int32 CurrentFrame;
+
+	//Time spent in the interaction path each frame, in ms
+	TArray<double> FrameTimes;
+
+	//What the engine was doing about fixed time steps before we took it over
+	bool bPreviousUseFixedTimeStep;
+	double PreviousFixedDeltaTime;
+
+	bool bRunning;
+
+	//The world or character went away before every frame was replayed
+	bool bStopped;
+
+};
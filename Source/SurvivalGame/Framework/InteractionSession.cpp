@@ -0,0 +1,371 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InteractionSession.h"
+#include "Components/InteractionComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerInput.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Compression.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace InteractionSession
+{
+	static const uint32 FileMagic = 0x53534E49; //"INSS"
+	static const int32 FileVersion = 1;
+
+	//bytes per frame before compression, anything claiming more frames than that fits is garbage
+	static const int32 FrameBytes = 21;
+}
+
+bool InteractionSession::Save(const FSession& Session, const FString& Path)
+{
+	TArray<uint8> Uncompressed;
+	FMemoryWriter Writer(Uncompressed);
+
+	FString MapName = Session.MapName;
+	int32 NumFrames = Session.Frames.Num();
+	int32 NumEvents = Session.Events.Num();
+	Writer << MapName << NumFrames << NumEvents;
+
+	//one field at a time across every frame, so similar bytes sit next to each other and compress better
+	for (const FFrame& Frame : Session.Frames)
+	{
+		float DeltaTime = Frame.DeltaTime;
+		Writer << DeltaTime;
+	}
+
+	for (const FFrame& Frame : Session.Frames)
+	{
+		FVector ViewLocation = Frame.ViewLocation;
+		Writer << ViewLocation;
+	}
+
+	//the view never rolls
+	for (const FFrame& Frame : Session.Frames)
+	{
+		uint16 Pitch = FRotator::CompressAxisToShort(Frame.ViewRotation.Pitch);
+		uint16 Yaw = FRotator::CompressAxisToShort(Frame.ViewRotation.Yaw);
+		Writer << Pitch << Yaw;
+	}
+
+	for (const FFrame& Frame : Session.Frames)
+	{
+		uint8 Flags = Frame.Flags;
+		Writer << Flags;
+	}
+
+	for (const FEvent& Event : Session.Events)
+	{
+		int32 EventFrame = Event.Frame;
+		uint8 Type = (uint8)Event.Type;
+		FString Target = Event.Target;
+		Writer << EventFrame << Type << Target;
+	}
+
+	int32 UncompressedSize = Uncompressed.Num();
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, UncompressedSize);
+
+	TArray<uint8> Compressed;
+	Compressed.SetNumUninitialized(CompressedSize);
+
+	if (!FCompression::CompressMemory(NAME_Zlib, Compressed.GetData(), CompressedSize, Uncompressed.GetData(), UncompressedSize))
+	{
+		return false;
+	}
+
+	Compressed.SetNum(CompressedSize);
+
+	TArray<uint8> File;
+	FMemoryWriter FileWriter(File);
+
+	uint32 Magic = FileMagic;
+	int32 Version = FileVersion;
+	FileWriter << Magic << Version << UncompressedSize;
+	File.Append(Compressed);
+
+	return FFileHelper::SaveArrayToFile(File, *Path);
+}
+
+bool InteractionSession::Load(const FString& Path, FSession& OutSession)
+{
+	TArray<uint8> File;
+	if (!FFileHelper::LoadFileToArray(File, *Path))
+	{
+		return false;
+	}
+
+	FMemoryReader FileReader(File);
+
+	uint32 Magic = 0;
+	int32 Version = 0;
+	int32 UncompressedSize = 0;
+	FileReader << Magic << Version << UncompressedSize;
+
+	if (FileReader.IsError() || Magic != FileMagic || Version != FileVersion || UncompressedSize <= 0)
+	{
+		return false;
+	}
+
+	const int32 HeaderSize = (int32)FileReader.Tell();
+
+	TArray<uint8> Uncompressed;
+	Uncompressed.SetNumUninitialized(UncompressedSize);
+
+	if (!FCompression::UncompressMemory(NAME_Zlib, Uncompressed.GetData(), UncompressedSize, File.GetData() + HeaderSize, File.Num() - HeaderSize))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Uncompressed);
+
+	int32 NumFrames = 0;
+	int32 NumEvents = 0;
+	Reader << OutSession.MapName << NumFrames << NumEvents;
+
+	if (Reader.IsError() || NumFrames < 0 || NumEvents < 0 || (int64)NumFrames * FrameBytes > Uncompressed.Num())
+	{
+		return false;
+	}
+
+	OutSession.Frames.SetNum(NumFrames);
+
+	for (FFrame& Frame : OutSession.Frames)
+	{
+		Reader << Frame.DeltaTime;
+	}
+
+	for (FFrame& Frame : OutSession.Frames)
+	{
+		Reader << Frame.ViewLocation;
+	}
+
+	for (FFrame& Frame : OutSession.Frames)
+	{
+		uint16 Pitch = 0, Yaw = 0;
+		Reader << Pitch << Yaw;
+		Frame.ViewRotation = FRotator(FRotator::DecompressAxisFromShort(Pitch), FRotator::DecompressAxisFromShort(Yaw), 0.f);
+	}
+
+	for (FFrame& Frame : OutSession.Frames)
+	{
+		Reader << Frame.Flags;
+	}
+
+	for (int32 i = 0; i < NumEvents && !Reader.IsError(); ++i)
+	{
+		FEvent& Event = OutSession.Events.AddDefaulted_GetRef();
+		uint8 Type = 0;
+		Reader << Event.Frame << Type << Event.Target;
+		Event.Type = (EInteractionEvent)Type;
+	}
+
+	return !Reader.IsError();
+}
+
+FString InteractionSession::GetTargetName(const UInteractionComponent* Interactable)
+{
+	const AActor* Owner = Interactable ? Interactable->GetOwner() : nullptr;
+
+	if (!Owner)
+	{
+		return TEXT("None");
+	}
+
+	const FVector Location = Owner->GetActorLocation();
+	return FString::Printf(TEXT("%s(%d,%d,%d)"), *Owner->GetClass()->GetName(), FMath::RoundToInt(Location.X), FMath::RoundToInt(Location.Y), FMath::RoundToInt(Location.Z));
+}
+
+const TCHAR* InteractionSession::GetEventName(const EInteractionEvent Event)
+{
+	switch (Event)
+	{
+	case EInteractionEvent::BeginFocus: return TEXT("BeginFocus");
+	case EInteractionEvent::EndFocus: return TEXT("EndFocus");
+	case EInteractionEvent::BeginInteract: return TEXT("BeginInteract");
+	case EInteractionEvent::EndInteract: return TEXT("EndInteract");
+	case EInteractionEvent::Interact: return TEXT("Interact");
+	}
+
+	return TEXT("Unknown");
+}
+
+FString InteractionSession::GetSessionPath(const FString& NameOrPath)
+{
+	if (FPaths::FileExists(NameOrPath))
+	{
+		return NameOrPath;
+	}
+
+	return FPaths::ProjectSavedDir() / TEXT("InteractionSessions") / FPaths::GetBaseFilename(NameOrPath) + TEXT(".isession");
+}
+
+static TWeakObjectPtr<USurvivalInteractionRecorder> ActiveRecorder;
+
+USurvivalInteractionRecorder::USurvivalInteractionRecorder()
+{
+	bInteractKeyDown = false;
+	bRecording = false;
+}
+
+void USurvivalInteractionRecorder::Start(ASurvivalCharacter* InCharacter, const FString& InPath)
+{
+	Character = InCharacter;
+	Path = InPath;
+
+	Session = InteractionSession::FSession();
+	Session.MapName = InCharacter->GetWorld()->GetMapName();
+	Session.MapName.RemoveFromStart(InCharacter->GetWorld()->StreamingLevelsPrefix);
+
+	CurrentFrame = InteractionSession::FFrame();
+	bInteractKeyDown = IsInteractKeyDown();
+
+	CheckHandle = InCharacter->OnInteractionCheck.AddUObject(this, &USurvivalInteractionRecorder::OnInteractionCheck);
+	EventHandle = InCharacter->OnInteractionEvent.AddUObject(this, &USurvivalInteractionRecorder::OnInteractionEvent);
+
+	bRecording = true;
+	AddToRoot();
+
+	UE_LOG(LogTemp, Log, TEXT("Recording interactions to %s"), *Path);
+}
+
+void USurvivalInteractionRecorder::Stop()
+{
+	if (!bRecording)
+	{
+		return;
+	}
+
+	bRecording = false;
+	RemoveFromRoot();
+
+	if (ASurvivalCharacter* RecordedCharacter = Character.Get())
+	{
+		RecordedCharacter->OnInteractionCheck.Remove(CheckHandle);
+		RecordedCharacter->OnInteractionEvent.Remove(EventHandle);
+	}
+
+	if (InteractionSession::Save(Session, Path))
+	{
+		UE_LOG(LogTemp, Log, TEXT("Saved %d frames and %d interaction events to %s"), Session.Frames.Num(), Session.Events.Num(), *Path);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Error, TEXT("Couldn't save the interaction session to %s"), *Path);
+	}
+}
+
+bool USurvivalInteractionRecorder::IsTickable() const
+{
+	return bRecording && !HasAnyFlags(RF_ClassDefaultObject);
+}
+
+TStatId USurvivalInteractionRecorder::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USurvivalInteractionRecorder, STATGROUP_Tickables);
+}
+
+void USurvivalInteractionRecorder::Tick(float DeltaTime)
+{
+	//died or left, keep what we've got
+	if (!Character.IsValid() || Character->IsPendingKill() || !Character->GetController())
+	{
+		Stop();
+		return;
+	}
+
+	//the key is read at the end of the frame, but it was handled by the controller at the start of it, before the check
+	const bool bKeyDown = IsInteractKeyDown();
+	if (bKeyDown != bInteractKeyDown)
+	{
+		CurrentFrame.Flags |= bKeyDown ? InteractionSession::FF_InteractPressed : InteractionSession::FF_InteractReleased;
+		bInteractKeyDown = bKeyDown;
+	}
+
+	CurrentFrame.DeltaTime = DeltaTime;
+	Session.Frames.Add(CurrentFrame);
+
+	//carry the view over, frames without a check still need somewhere to stand
+	CurrentFrame.Flags = 0;
+}
+
+void USurvivalInteractionRecorder::OnInteractionCheck(const FVector& ViewLocation, const FRotator& ViewRotation, const bool bUsingGamepad)
+{
+	CurrentFrame.ViewLocation = ViewLocation;
+	CurrentFrame.ViewRotation = ViewRotation;
+	CurrentFrame.Flags |= InteractionSession::FF_Check;
+
+	if (bUsingGamepad)
+	{
+		CurrentFrame.Flags |= InteractionSession::FF_Gamepad;
+	}
+}
+
+void USurvivalInteractionRecorder::OnInteractionEvent(const EInteractionEvent Event, UInteractionComponent* Interactable)
+{
+	InteractionSession::FEvent& NewEvent = Session.Events.AddDefaulted_GetRef();
+	NewEvent.Frame = Session.Frames.Num();
+	NewEvent.Type = Event;
+	NewEvent.Target = InteractionSession::GetTargetName(Interactable);
+}
+
+bool USurvivalInteractionRecorder::IsInteractKeyDown() const
+{
+	APlayerController* PC = Character.IsValid() ? Cast<APlayerController>(Character->GetController()) : nullptr;
+
+	if (!PC || !PC->PlayerInput)
+	{
+		return false;
+	}
+
+	for (const FInputActionKeyMapping& Mapping : PC->PlayerInput->GetKeysForAction(TEXT("Interact")))
+	{
+		if (PC->IsInputKeyDown(Mapping.Key))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void RecordInteractions(const TArray<FString>& Args, UWorld* World)
+{
+	if (ActiveRecorder.IsValid() && ActiveRecorder->IsTickable())
+	{
+		ActiveRecorder->Stop();
+		ActiveRecorder = nullptr;
+		return;
+	}
+
+	APlayerController* PC = World ? World->GetFirstPlayerController() : nullptr;
+	ASurvivalCharacter* Character = PC ? Cast<ASurvivalCharacter>(PC->GetPawn()) : nullptr;
+
+	if (!Character || !PC->IsLocalController())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Interaction recording needs a local player with a character."));
+		return;
+	}
+
+	FString Name = FString::Printf(TEXT("%s-%s"), *World->GetMapName(), *FDateTime::Now().ToString());
+
+	for (const FString& Arg : Args)
+	{
+		const FString Param = Arg.StartsWith(TEXT("-")) ? Arg : TEXT("-") + Arg;
+		FParse::Value(*Param, TEXT("Name="), Name);
+	}
+
+	USurvivalInteractionRecorder* Recorder = NewObject<USurvivalInteractionRecorder>();
+	ActiveRecorder = Recorder;
+	Recorder->Start(Character, InteractionSession::GetSessionPath(Name));
+}
+
+static FAutoConsoleCommandWithWorldAndArgs RecordInteractionsCommand(
+	TEXT("Survival.RecordInteractions"),
+	TEXT("Starts recording the local players interactions, or stops and saves the recording if one is running. Args: Name=<name>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RecordInteractions));
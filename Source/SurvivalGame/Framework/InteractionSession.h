@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Tickable.h"
+#include "Player/SurvivalCharacter.h"
+#include "InteractionSession.generated.h"
+
+/**
+ * A recording of one player's interaction: per frame the view the interaction check used, whether a check ran, and the
+ * interact key going down or up, plus every focus and interact event that came out of it. Replaying it with
+ * "Survival.ReplayInteractions" drives the same checks on the same map and compares the events it gets against these.
+ * Saved compressed, one field at a time across all frames. A frame is 21 bytes before compression.
+ */
+namespace InteractionSession
+{
+	enum EFrameFlags : uint8
+	{
+		FF_Check = 1 << 0,
+		FF_InteractPressed = 1 << 1,
+		FF_InteractReleased = 1 << 2,
+		FF_Gamepad = 1 << 3
+	};
+
+	struct FFrame
+	{
+		float DeltaTime = 0.f;
+		FVector ViewLocation = FVector::ZeroVector;
+		FRotator ViewRotation = FRotator::ZeroRotator;
+		uint8 Flags = 0;
+	};
+
+	struct FEvent
+	{
+		int32 Frame = 0;
+		EInteractionEvent Type = EInteractionEvent::BeginFocus;
+
+		//Which interactable, see GetTargetName
+		FString Target;
+	};
+
+	struct FSession
+	{
+		FString MapName;
+		TArray<FFrame> Frames;
+		TArray<FEvent> Events;
+	};
+
+	SURVIVALGAME_API bool Save(const FSession& Session, const FString& Path);
+	SURVIVALGAME_API bool Load(const FString& Path, FSession& OutSession);
+
+	//Names an interactable by its owners class and where it is, which stays the same between runs of a map when actor names don't
+	SURVIVALGAME_API FString GetTargetName(const class UInteractionComponent* Interactable);
+
+	SURVIVALGAME_API const TCHAR* GetEventName(const EInteractionEvent Event);
+
+	//Where sessions are saved to, and looked for when given by name rather than path
+	SURVIVALGAME_API FString GetSessionPath(const FString& NameOrPath);
+}
+
+/**
+ * Records the local players character into an interaction session until stopped, or the character goes away.
+ * Toggled with "Survival.RecordInteractions [Name=<name>]", and saved to Saved/InteractionSessions/.
+ */
+UCLASS(Transient)
+class SURVIVALGAME_API USurvivalInteractionRecorder : public UObject, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	USurvivalInteractionRecorder();
+
+	void Start(class ASurvivalCharacter* InCharacter, const FString& InPath);
+	void Stop();
+
+	//Called last thing in the frame, after the character has ticked, so it closes the frame off
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual bool IsTickableWhenPaused() const override { return false; }
+	virtual TStatId GetStatId() const override;
+
+protected:
+
+	void OnInteractionCheck(const FVector& ViewLocation, const FRotator& ViewRotation, const bool bUsingGamepad);
+	void OnInteractionEvent(const EInteractionEvent Event, class UInteractionComponent* Interactable);
+
+	//Whether any key mapped to Interact is down
+	bool IsInteractKeyDown() const;
+
+	TWeakObjectPtr<class ASurvivalCharacter> Character;
+
+	InteractionSession::FSession Session;
+
+	//The frame being recorded, filled in as the check runs and finished off in Tick
+	InteractionSession::FFrame CurrentFrame;
+
+	bool bInteractKeyDown;
+
+	FString Path;
+
+	FDelegateHandle CheckHandle;
+	FDelegateHandle EventHandle;
+
+	bool bRecording;
+
+};
@@ -0,0 +1,466 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SurvivalBenchmark.h"
+#include "Framework/SurvivalPerfCheck.h"
+#include "Player/SurvivalCharacter.h"
+#include "Components/InteractionComponent.h"
+#include "Components/InventoryComponent.h"
+#include "Components/BoxComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/GameModeBase.h"
+#include "Items/Item.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+
+//high above the map, so the scenarios only measure what they spawn themselves
+static const FVector BenchmarkOrigin(0.f, 0.f, 50000.f);
+
+//one interactable per this many units square, whatever the count, so the characters see a similar amount of them
+static const float InteractableSpacing = 100.f;
+
+static TWeakObjectPtr<USurvivalBenchmarkRunner> ActiveRunner;
+
+USurvivalBenchmarkRunner::USurvivalBenchmarkRunner()
+{
+	WarmupFrames = 60;
+	MeasureFrames = 300;
+	InventoryMutationsPerFrame = 32;
+	RegressionThreshold = 10.f;
+	bSaveBaseline = false;
+	bExitWhenDone = false;
+
+	CurrentScenario = 0;
+	ScenarioFrame = 0;
+	LastFrameTime = 0.0;
+	TotalFrameTime = 0.0;
+	StartUsedMemory = 0;
+	BenchmarkItem = nullptr;
+	bRunning = false;
+}
+
+void USurvivalBenchmarkRunner::Start(UWorld* InWorld)
+{
+	World = InWorld;
+
+	//characters are spawned and inventories only change on the server
+	if (!InWorld || !InWorld->GetAuthGameMode())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Benchmarks need to be run on the server or in standalone."));
+		return;
+	}
+
+	Scenarios.Reset();
+	Results.Reset();
+
+	for (const int32 NumInteractables : { 1000, 10000, 50000 })
+	{
+		FScenario& Scenario = Scenarios.AddDefaulted_GetRef();
+		Scenario.Name = FString::Printf(TEXT("Interactables_%d"), NumInteractables);
+		Scenario.NumInteractables = NumInteractables;
+		Scenario.NumCharacters = 1;
+	}
+
+	for (const int32 NumCharacters : { 16, 64 })
+	{
+		FScenario& Scenario = Scenarios.AddDefaulted_GetRef();
+		Scenario.Name = FString::Printf(TEXT("Characters_%d"), NumCharacters);
+		Scenario.NumInteractables = 1000;
+		Scenario.NumCharacters = NumCharacters;
+	}
+
+	for (const int32 NumStacks : { 10, 100, 1000 })
+	{
+		FScenario& Scenario = Scenarios.AddDefaulted_GetRef();
+		Scenario.Name = FString::Printf(TEXT("Inventory_%d"), NumStacks);
+		Scenario.NumInventoryStacks = NumStacks;
+	}
+
+	BenchmarkItem = NewObject<UItem>(this);
+	BenchmarkItem->bStackable = false;
+	BenchmarkItem->Weight = 0.1f;
+
+	//same seed every run, so every run does exactly the same work
+	Stream.Initialize(1337);
+
+	bRunning = true;
+	CurrentScenario = 0;
+	AddToRoot();
+
+	SetupScenario(Scenarios[CurrentScenario]);
+}
+
+bool USurvivalBenchmarkRunner::IsTickable() const
+{
+	return bRunning && !HasAnyFlags(RF_ClassDefaultObject);
+}
+
+TStatId USurvivalBenchmarkRunner::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USurvivalBenchmarkRunner, STATGROUP_Tickables);
+}
+
+void USurvivalBenchmarkRunner::Tick(float DeltaTime)
+{
+	if (!World.IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Benchmark world went away, stopping."));
+		bRunning = false;
+		RemoveFromRoot();
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+
+	//from the end of our last tick to now is one whole frame of the game, scenario updates included
+	if (ScenarioFrame > WarmupFrames)
+	{
+		const double FrameTime = Now - LastFrameTime;
+		TotalFrameTime += FrameTime;
+		Results.Last().MaxFrameMs = FMath::Max(Results.Last().MaxFrameMs, FrameTime * 1000.0);
+	}
+
+	if (++ScenarioFrame > WarmupFrames + MeasureFrames)
+	{
+		FScenarioResult& Result = Results.Last();
+		Result.AverageFrameMs = TotalFrameTime * 1000.0 / MeasureFrames;
+		Result.UsedPhysicalGrowthMB = ((double)FPlatformMemory::GetStats().UsedPhysical - (double)StartUsedMemory) / (1024.0 * 1024.0);
+		Result.UObjectCount = GUObjectArray.GetObjectArrayNumMinusAvailable();
+		Result.GCMs = MeasureGC();
+
+		UE_LOG(LogTemp, Log, TEXT("Benchmark %s: %.3f ms/frame (max %.3f), %.1f MB used physical growth, %d UObjects, %.3f ms GC"),
+			*Result.Name, Result.AverageFrameMs, Result.MaxFrameMs, Result.UsedPhysicalGrowthMB, Result.UObjectCount, Result.GCMs);
+
+		TeardownScenario();
+
+		if (++CurrentScenario >= Scenarios.Num())
+		{
+			Finish();
+			return;
+		}
+
+		SetupScenario(Scenarios[CurrentScenario]);
+
+		//setting up isnt part of the frame we're timing
+		LastFrameTime = FPlatformTime::Seconds();
+		return;
+	}
+
+	UpdateScenario();
+
+	LastFrameTime = Now;
+}
+
+void USurvivalBenchmarkRunner::SetupScenario(const FScenario& Scenario)
+{
+	UWorld* BenchmarkWorld = World.Get();
+
+	FScenarioResult& Result = Results.AddDefaulted_GetRef();
+	Result.Name = Scenario.Name;
+
+	ScenarioFrame = 0;
+	TotalFrameTime = 0.0;
+	StartUsedMemory = FPlatformMemory::GetStats().UsedPhysical;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	const float HalfExtent = FMath::Sqrt((float)Scenario.NumInteractables) * InteractableSpacing * 0.5f;
+
+	for (int32 i = 0; i < Scenario.NumInteractables; ++i)
+	{
+		const FVector Location = BenchmarkOrigin + FVector(Stream.FRandRange(-HalfExtent, HalfExtent), Stream.FRandRange(-HalfExtent, HalfExtent), Stream.FRandRange(0.f, 150.f));
+
+		AActor* Interactable = BenchmarkWorld->SpawnActor<AActor>(AActor::StaticClass(), FTransform(Location), SpawnParams);
+
+		//a box for the interaction trace to hit, like a pickups mesh would be
+		UBoxComponent* Box = NewObject<UBoxComponent>(Interactable);
+		Box->SetBoxExtent(FVector(25.f));
+		Box->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+		Box->SetCollisionResponseToAllChannels(ECR_Block);
+		Interactable->SetRootComponent(Box);
+		Box->RegisterComponent();
+		Box->SetWorldLocation(Location);
+
+		UInteractionComponent* Interaction = NewObject<UInteractionComponent>(Interactable);
+		Interaction->SetupAttachment(Box);
+		Interaction->RegisterComponent();
+
+		SpawnedActors.Add(Interactable);
+	}
+
+	TSubclassOf<APawn> DefaultPawnClass = BenchmarkWorld->GetAuthGameMode()->DefaultPawnClass;
+	TSubclassOf<ASurvivalCharacter> CharacterClass = DefaultPawnClass && DefaultPawnClass->IsChildOf(ASurvivalCharacter::StaticClass()) ? *DefaultPawnClass : ASurvivalCharacter::StaticClass();
+
+	for (int32 i = 0; i < Scenario.NumCharacters; ++i)
+	{
+		const FVector Location = BenchmarkOrigin + FVector(Stream.FRandRange(-HalfExtent, HalfExtent) * 0.5f, Stream.FRandRange(-HalfExtent, HalfExtent) * 0.5f, 100.f);
+
+		if (ASurvivalCharacter* Character = BenchmarkWorld->SpawnActor<ASurvivalCharacter>(CharacterClass, FTransform(Location), SpawnParams))
+		{
+			//keeps them up among the interactables instead of falling out of the sky
+			Character->GetCharacterMovement()->SetMovementMode(MOVE_Flying);
+
+			//the interaction check needs a controller to get the view from
+			Character->SpawnDefaultController();
+
+			SpawnedActors.Add(Character);
+			SpawnedActors.Add(Character->GetController());
+			SweepingCharacters.Add(Character);
+		}
+	}
+
+	if (Scenario.NumInventoryStacks > 0)
+	{
+		if (ASurvivalCharacter* Character = BenchmarkWorld->SpawnActor<ASurvivalCharacter>(CharacterClass, FTransform(BenchmarkOrigin), SpawnParams))
+		{
+			Character->GetCharacterMovement()->SetMovementMode(MOVE_Flying);
+			SpawnedActors.Add(Character);
+
+			UInventoryComponent* Inventory = Character->PlayerInventory;
+			Inventory->SetCapacity(Scenario.NumInventoryStacks + InventoryMutationsPerFrame);
+			Inventory->SetWeightCapacity(BIG_NUMBER);
+
+			for (int32 i = 0; i < Scenario.NumInventoryStacks; ++i)
+			{
+				Inventory->TryAddItem(BenchmarkItem);
+			}
+
+			BenchmarkInventory = Inventory;
+		}
+	}
+}
+
+void USurvivalBenchmarkRunner::UpdateScenario()
+{
+	//every character turns at its own offset, so they're all looking at different things
+	for (int32 i = 0; i < SweepingCharacters.Num(); ++i)
+	{
+		if (ASurvivalCharacter* Character = SweepingCharacters[i].Get())
+		{
+			Character->SetActorRotation(FRotator(0.f, FMath::Fmod(ScenarioFrame * 6.f + i * 37.f, 360.f), 0.f));
+		}
+	}
+
+	if (UInventoryComponent* Inventory = BenchmarkInventory.Get())
+	{
+		for (int32 i = 0; i < InventoryMutationsPerFrame; ++i)
+		{
+			const TArray<UItem*> Items = Inventory->GetItems();
+
+			if (Items.Num() > 0)
+			{
+				Inventory->ConsumeItem(Items[Stream.RandHelper(Items.Num())]);
+			}
+
+			Inventory->TryAddItem(BenchmarkItem);
+		}
+	}
+}
+
+void USurvivalBenchmarkRunner::TeardownScenario()
+{
+	for (const TWeakObjectPtr<AActor>& Actor : SpawnedActors)
+	{
+		if (Actor.IsValid())
+		{
+			Actor->Destroy();
+		}
+	}
+
+	SpawnedActors.Reset();
+	SweepingCharacters.Reset();
+	BenchmarkInventory = nullptr;
+
+	//clean up now, so the next scenario starts from the same memory and object count
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+}
+
+double USurvivalBenchmarkRunner::MeasureGC() const
+{
+	const double StartTime = FPlatformTime::Seconds();
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+	return (FPlatformTime::Seconds() - StartTime) * 1000.0;
+}
+
+void USurvivalBenchmarkRunner::Finish()
+{
+	bRunning = false;
+	RemoveFromRoot();
+
+	//anything that means we couldn't say the benchmarks passed fails the run, so a ci job quitting with -ExitAfterBenchmarks fails too
+	bool bFailed = false;
+
+	if (SaveResults(OutputPath))
+	{
+		UE_LOG(LogTemp, Log, TEXT("Benchmark results written to %s"), *OutputPath);
+	}
+	else
+	{
+		bFailed = true;
+	}
+
+	if (bSaveBaseline)
+	{
+		if (SaveResults(BaselinePath))
+		{
+			UE_LOG(LogTemp, Log, TEXT("Benchmark baseline written to %s"), *BaselinePath);
+		}
+		else
+		{
+			bFailed = true;
+		}
+	}
+	else
+	{
+		TArray<FScenarioResult> Baseline;
+
+		if (LoadResults(BaselinePath, Baseline))
+		{
+			const int32 NumRegressions = CompareAgainstBaseline(Baseline);
+
+			if (NumRegressions > 0)
+			{
+				UE_LOG(LogTemp, Error, TEXT("Benchmarks failed, %d metrics regressed more than %.1f%% or were missing from %s"), NumRegressions, RegressionThreshold, *BaselinePath);
+				bFailed = true;
+			}
+			else
+			{
+				UE_LOG(LogTemp, Log, TEXT("Benchmarks passed against %s"), *BaselinePath);
+			}
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("No benchmark baseline at %s, nothing to compare against."), *BaselinePath);
+			bFailed = true;
+		}
+	}
+
+	if (bExitWhenDone)
+	{
+		SurvivalPerfCheck::RequestExit(bFailed);
+	}
+}
+
+bool USurvivalBenchmarkRunner::SaveResults(const FString& Path) const
+{
+	TArray<TSharedPtr<FJsonValue>> ScenarioValues;
+
+	for (const FScenarioResult& Result : Results)
+	{
+		TSharedRef<FJsonObject> ScenarioObject = MakeShared<FJsonObject>();
+		ScenarioObject->SetStringField(TEXT("Name"), Result.Name);
+		ScenarioObject->SetNumberField(TEXT("AverageFrameMs"), Result.AverageFrameMs);
+		ScenarioObject->SetNumberField(TEXT("MaxFrameMs"), Result.MaxFrameMs);
+		ScenarioObject->SetNumberField(TEXT("UsedPhysicalGrowthMB"), Result.UsedPhysicalGrowthMB);
+		ScenarioObject->SetNumberField(TEXT("UObjectCount"), Result.UObjectCount);
+		ScenarioObject->SetNumberField(TEXT("GCMs"), Result.GCMs);
+		ScenarioValues.Add(MakeShared<FJsonValueObject>(ScenarioObject));
+	}
+
+	TSharedRef<FJsonObject> RootObject = MakeShared<FJsonObject>();
+	RootObject->SetNumberField(TEXT("WarmupFrames"), WarmupFrames);
+	RootObject->SetNumberField(TEXT("MeasureFrames"), MeasureFrames);
+	RootObject->SetArrayField(TEXT("Scenarios"), ScenarioValues);
+
+	return SurvivalPerfCheck::SaveJson(RootObject, Path);
+}
+
+bool USurvivalBenchmarkRunner::LoadResults(const FString& Path, TArray<FScenarioResult>& OutResults) const
+{
+	const TSharedPtr<FJsonObject> RootObject = SurvivalPerfCheck::LoadJson(Path);
+
+	const TArray<TSharedPtr<FJsonValue>>* ScenarioValues = nullptr;
+	if (!RootObject.IsValid() || !RootObject->TryGetArrayField(TEXT("Scenarios"), ScenarioValues))
+	{
+		return false;
+	}
+
+	for (const TSharedPtr<FJsonValue>& ScenarioValue : *ScenarioValues)
+	{
+		const TSharedPtr<FJsonObject> ScenarioObject = ScenarioValue->AsObject();
+
+		if (ScenarioObject.IsValid())
+		{
+			FScenarioResult& Result = OutResults.AddDefaulted_GetRef();
+			Result.Name = ScenarioObject->GetStringField(TEXT("Name"));
+			Result.AverageFrameMs = ScenarioObject->GetNumberField(TEXT("AverageFrameMs"));
+			Result.MaxFrameMs = ScenarioObject->GetNumberField(TEXT("MaxFrameMs"));
+			Result.UsedPhysicalGrowthMB = ScenarioObject->GetNumberField(TEXT("UsedPhysicalGrowthMB"));
+			Result.UObjectCount = (int32)ScenarioObject->GetNumberField(TEXT("UObjectCount"));
+			Result.GCMs = ScenarioObject->GetNumberField(TEXT("GCMs"));
+		}
+	}
+
+	return true;
+}
+
+int32 USurvivalBenchmarkRunner::CompareAgainstBaseline(const TArray<FScenarioResult>& Baseline) const
+{
+	SurvivalPerfCheck::FRegressionCheck Check(TEXT("Benchmark"), RegressionThreshold);
+
+	//max frame time is left out, a single hitch from the OS would fail the run
+	for (const FScenarioResult& Result : Results)
+	{
+		const FScenarioResult* BaselineResult = Baseline.FindByPredicate([&Result](const FScenarioResult& Other) { return Other.Name == Result.Name; });
+
+		//a ci run can't pass on something it never checked, interactively it's just a new scenario to record
+		if (!BaselineResult)
+		{
+			if (bExitWhenDone)
+			{
+				UE_LOG(LogTemp, Error, TEXT("Benchmark %s isn't in the baseline"), *Result.Name);
+				++Check.NumRegressions;
+			}
+			else
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Benchmark %s isn't in the baseline yet"), *Result.Name);
+			}
+
+			continue;
+		}
+
+		Check.CheckMetric(Result.Name, TEXT("AverageFrameMs"), Result.AverageFrameMs, BaselineResult->AverageFrameMs, SurvivalPerfCheck::MinFrameRegressionMs);
+		Check.CheckMetric(Result.Name, TEXT("UsedPhysicalGrowthMB"), Result.UsedPhysicalGrowthMB, BaselineResult->UsedPhysicalGrowthMB, SurvivalPerfCheck::MinRegressionMB);
+		Check.CheckMetric(Result.Name, TEXT("UObjectCount"), Result.UObjectCount, BaselineResult->UObjectCount, 0.0);
+		Check.CheckMetric(Result.Name, TEXT("GCMs"), Result.GCMs, BaselineResult->GCMs, SurvivalPerfCheck::MinFrameRegressionMs);
+	}
+
+	return Check.NumRegressions;
+}
+
+static void RunBenchmarks(const TArray<FString>& Args, UWorld* World)
+{
+	if (ActiveRunner.IsValid() && ActiveRunner->IsTickable())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Benchmarks are already running."));
+		return;
+	}
+
+	USurvivalBenchmarkRunner* Runner = NewObject<USurvivalBenchmarkRunner>();
+	Runner->OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / TEXT("SurvivalBenchmark.json");
+	Runner->BaselinePath = FPaths::ProjectDir() / TEXT("Benchmarks") / TEXT("SurvivalBenchmarkBaseline.json");
+	Runner->bExitWhenDone = FParse::Param(FCommandLine::Get(), TEXT("ExitAfterBenchmarks"));
+
+	for (const FString& Param : SurvivalPerfCheck::GetParams(Args))
+	{
+		FParse::Value(*Param, TEXT("Output="), Runner->OutputPath);
+		FParse::Value(*Param, TEXT("Baseline="), Runner->BaselinePath);
+		FParse::Value(*Param, TEXT("Threshold="), Runner->RegressionThreshold);
+		FParse::Value(*Param, TEXT("Frames="), Runner->MeasureFrames);
+		Runner->bSaveBaseline |= FParse::Param(*Param, TEXT("SaveBaseline"));
+	}
+
+	Runner->MeasureFrames = FMath::Max(Runner->MeasureFrames, 1);
+
+	ActiveRunner = Runner;
+	Runner->Start(World);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs RunBenchmarksCommand(
+	TEXT("Survival.RunBenchmarks"),
+	TEXT("Runs the gameplay benchmark scenarios and checks them against a baseline. Args: Output=<json> Baseline=<json> Threshold=<percent> Frames=<n> SaveBaseline"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunBenchmarks));
@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Tickable.h"
+#include "SurvivalBenchmark.generated.h"
+
+/**
+ * Runs the gameplay benchmark scenarios one after another in a running world: thousands of interactables, many characters
+ * sweeping their view, and inventories with lots of stacks being mutated. Each scenario warms up, then gets timed over a
+ * fixed number of frames, and reports ms per frame, growth in the process's used physical memory, UObject count and GC time.
+ * Memory is what the OS says the process is using, not a count of allocations, so it only moves once allocations add up to whole pages.
+ * Results are written as json, and compared against a baseline json so regressions past the threshold are logged as errors.
+ * The baseline lives at Benchmarks/SurvivalBenchmarkBaseline.json. Record it on the reference machine with SaveBaseline and check it in,
+ * a scenario missing from it fails a -ExitAfterBenchmarks run the same as a regression.
+ *
+ * Started with "Survival.RunBenchmarks". Headless on a server: -nullrhi -benchmark -ExecCmds="Survival.RunBenchmarks"
+ * -benchmark is there so frames aren't padded out to the server tick rate. Add -ExitAfterBenchmarks to quit when done,
+ * with a non-zero exit code if anything regressed or there was no baseline to check against.
+ */
+UCLASS(Transient)
+class SURVIVALGAME_API USurvivalBenchmarkRunner : public UObject, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+
+	USurvivalBenchmarkRunner();
+
+	//Frames each scenario runs for before and during timing
+	int32 WarmupFrames;
+	int32 MeasureFrames;
+
+	//Inventory operations per frame in the inventory scenarios
+	int32 InventoryMutationsPerFrame;
+
+	//How much worse than the baseline a metric can get, as a percentage, before it counts as a regression
+	float RegressionThreshold;
+
+	//Where results go, and the baseline they're checked against. No baseline means nothing to check against
+	FString OutputPath;
+	FString BaselinePath;
+
+	//Write the results over the baseline as well, to check in as the new one
+	bool bSaveBaseline;
+
+	//Quit once the run is done
+	bool bExitWhenDone;
+
+	//Set up the scenarios and start running them in World. Only one run at a time
+	void Start(UWorld* InWorld);
+
+	//FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual bool IsTickableWhenPaused() const override { return false; }
+	virtual TStatId GetStatId() const override;
+
+protected:
+
+	struct FScenario
+	{
+		FString Name;
+		int32 NumInteractables = 0;
+		int32 NumCharacters = 0;
+		int32 NumInventoryStacks = 0;
+	};
+
+	struct FScenarioResult
+	{
+		FString Name;
+		double AverageFrameMs = 0.0;
+		double MaxFrameMs = 0.0;
+		double UsedPhysicalGrowthMB = 0.0;
+		int32 UObjectCount = 0;
+		double GCMs = 0.0;
+	};
+
+	void SetupScenario(const FScenario& Scenario);
+	void UpdateScenario();
+	void TeardownScenario();
+
+	//Time a full purge with everything in the scenario still alive
+	double MeasureGC() const;
+
+	void Finish();
+
+	//Write the results as json, and read them back from a baseline
+	bool SaveResults(const FString& Path) const;
+	bool LoadResults(const FString& Path, TArray<FScenarioResult>& OutResults) const;
+
+	//Log every metric worse than the baseline by more than RegressionThreshold. Returns how many there were, a scenario the baseline
+	//doesn't have counts as one when we're going to exit with the result
+	int32 CompareAgainstBaseline(const TArray<FScenarioResult>& Baseline) const;
+
+	TWeakObjectPtr<UWorld> World;
+
+	TArray<FScenario> Scenarios;
+	TArray<FScenarioResult> Results;
+	int32 CurrentScenario;
+
+	//Frames run in the current scenario, the warmup included
+	int32 ScenarioFrame;
+
+	double LastFrameTime;
+	double TotalFrameTime;
+	uint64 StartUsedMemory;
+
+	//Everything the current scenario spawned, destroyed on teardown
+	TArray<TWeakObjectPtr<AActor>> SpawnedActors;
+	TArray<TWeakObjectPtr<class ASurvivalCharacter>> SweepingCharacters;
+	TWeakObjectPtr<class UInventoryComponent> BenchmarkInventory;
+
+	//Template for the items the inventory scenarios add, unstackable so every add is a new stack
+	UPROPERTY()
+	class UItem* BenchmarkItem;
+
+	FRandomStream Stream;
+
+	bool bRunning;
+
+};
@@ -2,4 +2,30 @@
 
 
 #include "SurvivalGameGameModeBase.h"
+#include "Components/LootSpawnerComponent.h"
+#include "Components/ItemLifecycleComponent.h"
+#include "Components/StatusEffectComponent.h"
+#include "Components/LoadTestMonitorComponent.h"
+#include "Framework/SurvivalGameStateBase.h"
 
+ASurvivalGameGameModeBase::ASurvivalGameGameModeBase()
+{
+	LootSpawner = CreateDefaultSubobject<ULootSpawnerComponent>("LootSpawner");
+	ItemLifecycle = CreateDefaultSubobject<UItemLifecycleComponent>("ItemLifecycle");
+	StatusEffects = CreateDefaultSubobject<UStatusEffectComponent>("StatusEffects");
+	LoadTestMonitor = CreateDefaultSubobject<ULoadTestMonitorComponent>("LoadTestMonitor");
+
+	//the game state streams loot baselines to joining players, so we need ours
+	GameStateClass = ASurvivalGameStateBase::StaticClass();
+}
+
+
+void ASurvivalGameGameModeBase::PostLogin(APlayerController* NewPlayer)
+{
+	Super::PostLogin(NewPlayer);
+
+	if (ASurvivalGameStateBase* SurvivalGameState = GetGameState<ASurvivalGameStateBase>())
+	{
+		SurvivalGameState->StartLootBaselineStream(NewPlayer);
+	}
+}
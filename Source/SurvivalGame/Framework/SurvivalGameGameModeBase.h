@@ -13,5 +13,30 @@ UCLASS()
 class SURVIVALGAME_API ASurvivalGameGameModeBase : public AGameModeBase
 {
 	GENERATED_BODY()
+
+public:
+
+	ASurvivalGameGameModeBase();
+
+	//Fills the map with pickups at server start and respawns them
+	UPROPERTY(EditAnywhere, Category = "Components")
+	class ULootSpawnerComponent* LootSpawner;
+
+	//Despawns dropped pickups and decays perishable items
+	UPROPERTY(EditAnywhere, Category = "Components")
+	class UItemLifecycleComponent* ItemLifecycle;
+
+	//Runs every status effect on every character, e.g. from food and medicine
+	UPROPERTY(EditAnywhere, Category = "Components")
+	class UStatusEffectComponent* StatusEffects;
+
+	//Records server cost per connection when the server is load tested with bots
+	UPROPERTY(EditAnywhere, Category = "Components")
+	class ULoadTestMonitorComponent* LoadTestMonitor;
+
+protected:
+
+	//Starts streaming the world loot baseline to the new player
+	virtual void PostLogin(APlayerController* NewPlayer) override;
 	
 };
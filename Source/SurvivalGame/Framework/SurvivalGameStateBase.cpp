@@ -2,4 +2,496 @@
 
 
 #include "SurvivalGameStateBase.h"
+#include "Framework/SurvivalPlayerController.h"
+#include "Items/Item.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/World.h"
+#include "Net/UnrealNetwork.h"
+#include "TimerManager.h"
 
+//how often the server sends baseline chunks, the byte budget is spread over these
+static const float BaselineStreamInterval = 0.1f;
+
+//how many of a region's last changes we keep to send as deltas, anyone further behind gets the whole region again
+static const int32 MaxRegionDeltas = 8;
+
+ASurvivalGameStateBase::ASurvivalGameStateBase()
+{
+	LootActivationDistance = 15000.f;
+	LootDeactivationMargin = 2000.f;
+	MaxBaselineBytesPerSecond = 32 * 1024;
+	BaselineChunkSize = 1024;
+}
+
+void ASurvivalGameStateBase::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (HasAuthority())
+	{
+		GetWorldTimerManager().SetTimer(TimerHandle_StreamBaselines, this, &ASurvivalGameStateBase::StreamLootBaselines, BaselineStreamInterval, true);
+	}
+
+	//baseline chunks can beat us to the client, our player controller holds on to them until we're here
+	if (!HasAuthority())
+	{
+		for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+		{
+			if (ASurvivalPlayerController* PC = Cast<ASurvivalPlayerController>(It->Get()))
+			{
+				PC->DeliverLootBaselineChunks();
+			}
+		}
+	}
+
+	if (GetNetMode() != NM_DedicatedServer)
+	{
+		GetWorldTimerManager().SetTimer(TimerHandle_ProxyVisibility, this, &ASurvivalGameStateBase::UpdateLootProxyVisibility, 0.5f, true);
+	}
+}
+
+void ASurvivalGameStateBase::GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ASurvivalGameStateBase, LootItemClasses);
+}
+
+uint16 ASurvivalGameStateBase::GetLootItemId(TSubclassOf<class UItem> ItemClass)
+{
+	return (uint16)(LootItemClasses.AddUnique(ItemClass) + 1);
+}
+
+void ASurvivalGameStateBase::UpdateLootRegion(const int32 RegionIndex, const FBox& Bounds, const TArray<LootBaseline::FEntry>& Entries)
+{
+	if (!HasAuthority() || RegionIndex < 0)
+	{
+		return;
+	}
+
+	if (!ServerRegions.IsValidIndex(RegionIndex))
+	{
+		ServerRegions.SetNum(RegionIndex + 1);
+	}
+
+	FServerRegionBaseline& Region = ServerRegions[RegionIndex];
+
+	//match what's there now against what clients already have, at the precision they have it. Whatever is left over on either side is the delta
+	TMap<LootBaseline::FQuantizedEntry, int32> Unmatched;
+
+	for (const LootBaseline::FEntry& Entry : Entries)
+	{
+		++Unmatched.FindOrAdd(LootBaseline::Quantize(Bounds, Entry));
+	}
+
+	TArray<LootBaseline::FEntry> NewEntries;
+	TArray<int32> Removed;
+	TArray<LootBaseline::FEntry> Added;
+	TArray<LootBaseline::FEntry> ChangedEntries;
+
+	for (int32 Index = 0; Index < Region.Entries.Num(); ++Index)
+	{
+		int32* Count = Unmatched.Find(LootBaseline::Quantize(Bounds, Region.Entries[Index]));
+
+		if (Count && *Count > 0)
+		{
+			--*Count;
+			NewEntries.Add(Region.Entries[Index]);
+		}
+		else
+		{
+			Removed.Add(Index);
+			ChangedEntries.Add(Region.Entries[Index]);
+		}
+	}
+
+	for (const LootBaseline::FEntry& Entry : Entries)
+	{
+		int32& Count = Unmatched.FindChecked(LootBaseline::Quantize(Bounds, Entry));
+
+		if (Count > 0)
+		{
+			--Count;
+			Added.Add(Entry);
+		}
+	}
+
+	//e.g. a region going dormant, the same loot just isn't actors anymore
+	if (Region.Version > 0 && Removed.Num() == 0 && Added.Num() == 0 && Region.Bounds == Bounds)
+	{
+		return;
+	}
+
+	NewEntries.Append(Added);
+	ChangedEntries.Append(Added);
+
+	Region.Bounds = Bounds;
+	Region.Entries = MoveTemp(NewEntries);
+	LootBaseline::Encode(Bounds, Region.Entries, Region.Data, Region.UncompressedSize);
+
+	//anyone who had the last version only needs this
+	if (Region.Version > 0)
+	{
+		FRegionDelta& Delta = Region.Deltas.AddDefaulted_GetRef();
+		Delta.Version = Region.Version + 1;
+		LootBaseline::EncodeDelta(Bounds, Removed, Added, Delta.Data, Delta.UncompressedSize);
+
+		if (Region.Deltas.Num() > MaxRegionDeltas)
+		{
+			Region.Deltas.RemoveAt(0);
+		}
+	}
+
+	++Region.Version;
+
+	//a listen server host doesnt get sent baselines, so draw them straight from the entries
+	if (GetNetMode() != NM_DedicatedServer)
+	{
+		FClientRegionLoot& LocalRegion = ClientRegions.FindOrAdd(RegionIndex);
+		LocalRegion.Bounds = Bounds;
+		LocalRegion.Entries = Region.Entries;
+		LocalRegion.Version = Region.Version;
+		UpdateLootProxies(RegionIndex, &ChangedEntries);
+	}
+
+	//anyone who already has this region needs the new version. It goes to the back of their queue, behind what they haven't seen at all
+	for (FBaselineStream& Stream : Streams)
+	{
+		if (!Stream.RegionQueue.Contains(RegionIndex))
+		{
+			Stream.RegionQueue.Add(RegionIndex);
+		}
+	}
+}
+
+void ASurvivalGameStateBase::StartLootBaselineStream(class APlayerController* PlayerController)
+{
+	if (!HasAuthority() || !PlayerController || PlayerController->IsLocalController())
+	{
+		return;
+	}
+
+	FVector PlayerLocation;
+	FRotator PlayerRotation;
+	PlayerController->GetPlayerViewPoint(PlayerLocation, PlayerRotation);
+
+	FBaselineStream& Stream = Streams.AddDefaulted_GetRef();
+	Stream.PlayerController = PlayerController;
+	Stream.SentVersions.Init(0, ServerRegions.Num());
+
+	for (int32 RegionIndex = 0; RegionIndex < ServerRegions.Num(); ++RegionIndex)
+	{
+		Stream.RegionQueue.Add(RegionIndex);
+	}
+
+	//the loot around where the player spawns is what they need to see first
+	Stream.RegionQueue.Sort([this, &PlayerLocation](const int32 A, const int32 B)
+	{
+		return ServerRegions[A].Bounds.ComputeSquaredDistanceToPoint(PlayerLocation) < ServerRegions[B].Bounds.ComputeSquaredDistanceToPoint(PlayerLocation);
+	});
+}
+
+void ASurvivalGameStateBase::StreamLootBaselines()
+{
+	const int32 BytesPerStream = FMath::Max(FMath::RoundToInt(MaxBaselineBytesPerSecond * BaselineStreamInterval), BaselineChunkSize);
+
+	Streams.RemoveAll([](const FBaselineStream& Stream) { return !Stream.PlayerController.IsValid(); });
+
+	for (FBaselineStream& Stream : Streams)
+	{
+		ASurvivalPlayerController* PC = Cast<ASurvivalPlayerController>(Stream.PlayerController.Get());
+		int32 BytesSent = 0;
+
+		while (PC && Stream.RegionQueue.Num() > 0 && BytesSent < BytesPerStream)
+		{
+			const int32 RegionIndex = Stream.RegionQueue[0];
+			const FServerRegionBaseline& Region = ServerRegions[RegionIndex];
+
+			if (!Stream.SentVersions.IsValidIndex(RegionIndex))
+			{
+				Stream.SentVersions.SetNumZeroed(RegionIndex + 1);
+			}
+
+			const int32 SentVersion = Stream.SentVersions[RegionIndex];
+
+			if (Stream.NextChunk == 0)
+			{
+				//they already have this one, e.g. it was queued twice before we got to it
+				if (SentVersion == Region.Version)
+				{
+					Stream.RegionQueue.RemoveAt(0, 1, false);
+					continue;
+				}
+
+				//if they have an older version, what changed since is usually far smaller than the whole region
+				const FRegionDelta* NextDelta = SentVersion > 0 ? Region.Deltas.FindByPredicate([SentVersion](const FRegionDelta& Delta) { return Delta.Version == SentVersion + 1; }) : nullptr;
+
+				if (NextDelta && NextDelta->Data.Num() < Region.Data.Num())
+				{
+					Stream.SendingBaseVersion = SentVersion;
+					Stream.SendingVersion = NextDelta->Version;
+				}
+				else
+				{
+					Stream.SendingBaseVersion = 0;
+					Stream.SendingVersion = Region.Version;
+				}
+			}
+
+			const int32 SendingVersion = Stream.SendingVersion;
+			const FRegionDelta* Delta = Stream.SendingBaseVersion > 0 ? Region.Deltas.FindByPredicate([SendingVersion](const FRegionDelta& RegionDelta) { return RegionDelta.Version == SendingVersion; }) : nullptr;
+
+			//the region changed halfway through sending all of it, or the delta we were sending got too old to keep. Start again from the top
+			if (Stream.SendingBaseVersion > 0 ? !Delta : Stream.SendingVersion != Region.Version)
+			{
+				Stream.NextChunk = 0;
+				continue;
+			}
+
+			const TArray<uint8>& Data = Delta ? Delta->Data : Region.Data;
+			const int32 UncompressedSize = Delta ? Delta->UncompressedSize : Region.UncompressedSize;
+
+			const int32 NumChunks = FMath::Max(FMath::DivideAndRoundUp(Data.Num(), BaselineChunkSize), 1);
+			const int32 ChunkStart = Stream.NextChunk * BaselineChunkSize;
+			const int32 ChunkLength = FMath::Clamp(Data.Num() - ChunkStart, 0, BaselineChunkSize);
+
+			TArray<uint8> Chunk;
+			Chunk.Append(Data.GetData() + ChunkStart, ChunkLength);
+
+			PC->ClientReceiveLootBaseline(RegionIndex, Stream.SendingBaseVersion, Stream.SendingVersion, Stream.NextChunk, NumChunks, UncompressedSize, Chunk);
+
+			BytesSent += ChunkLength;
+
+			if (++Stream.NextChunk >= NumChunks)
+			{
+				Stream.SentVersions[RegionIndex] = Stream.SendingVersion;
+				Stream.NextChunk = 0;
+
+				//a delta can leave them still behind if the region has changed more than once, the next pass sends the one after
+				if (Stream.SendingVersion == Region.Version)
+				{
+					Stream.RegionQueue.RemoveAt(0, 1, false);
+				}
+			}
+		}
+	}
+}
+
+void ASurvivalGameStateBase::ReceiveLootBaselineChunk(const int32 RegionIndex, const int32 BaseVersion, const int32 Version, const int32 ChunkIndex, const int32 NumChunks, const int32 UncompressedSize, const TArray<uint8>& Data)
+{
+	FClientRegionLoot& Region = ClientRegions.FindOrAdd(RegionIndex);
+
+	//first chunk of a new version throws away anything half received of an older one
+	if (ChunkIndex == 0 || Version != Region.IncomingVersion || BaseVersion != Region.IncomingBaseVersion)
+	{
+		Region.IncomingVersion = Version;
+		Region.IncomingBaseVersion = BaseVersion;
+		Region.IncomingData.Reset();
+		Region.IncomingChunks = 0;
+	}
+
+	//chunks are sent reliably and in order, so a gap means we missed the start of this version. Wait for the next one
+	if (ChunkIndex != Region.IncomingChunks)
+	{
+		return;
+	}
+
+	Region.IncomingData.Append(Data);
+	++Region.IncomingChunks;
+
+	if (Region.IncomingChunks < NumChunks)
+	{
+		return;
+	}
+
+	FBox Bounds;
+
+	if (BaseVersion == 0)
+	{
+		TArray<LootBaseline::FEntry> Entries;
+
+		if (LootBaseline::Decode(Region.IncomingData, UncompressedSize, Bounds, Entries))
+		{
+			Region.Bounds = Bounds;
+			Region.Entries = MoveTemp(Entries);
+			Region.Version = Version;
+			UpdateLootProxies(RegionIndex);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Couldn't decode the loot baseline for region %d."), RegionIndex);
+		}
+	}
+	else
+	{
+		TArray<int32> Removed;
+		TArray<LootBaseline::FEntry> Added;
+
+		//the server only sends a delta on top of a version it finished sending us, so this is only false if something is corrupt
+		if (BaseVersion == Region.Version && LootBaseline::DecodeDelta(Region.IncomingData, UncompressedSize, Bounds, Removed, Added))
+		{
+			TArray<LootBaseline::FEntry> ChangedEntries;
+
+			for (const int32 Index : Removed)
+			{
+				if (Region.Entries.IsValidIndex(Index))
+				{
+					ChangedEntries.Add(Region.Entries[Index]);
+				}
+			}
+
+			ChangedEntries.Append(Added);
+
+			if (LootBaseline::ApplyDelta(Region.Entries, Removed, Added))
+			{
+				Region.Bounds = Bounds;
+				Region.Version = Version;
+				UpdateLootProxies(RegionIndex, &ChangedEntries);
+			}
+			else
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Loot delta for region %d doesn't match the entries we have."), RegionIndex);
+			}
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Couldn't apply the loot delta from version %d to %d for region %d, we have version %d."), BaseVersion, Version, RegionIndex, Region.Version);
+		}
+	}
+
+	Region.IncomingData.Empty();
+	Region.IncomingChunks = 0;
+	Region.IncomingVersion = INDEX_NONE;
+}
+
+void ASurvivalGameStateBase::OnRep_LootItemClasses()
+{
+	for (const TPair<int32, FClientRegionLoot>& Region : ClientRegions)
+	{
+		UpdateLootProxies(Region.Key);
+	}
+}
+
+void ASurvivalGameStateBase::UpdateLootProxies(const int32 RegionIndex, const TArray<LootBaseline::FEntry>* ChangedEntries)
+{
+	FClientRegionLoot* Region = ClientRegions.Find(RegionIndex);
+
+	if (!Region || GetNetMode() == NM_DedicatedServer)
+	{
+		return;
+	}
+
+	auto GetEntryMesh = [this](const LootBaseline::FEntry& Entry) -> UStaticMesh*
+	{
+		const TSubclassOf<UItem> ItemClass = LootItemClasses.IsValidIndex(Entry.ItemId - 1) ? LootItemClasses[Entry.ItemId - 1] : TSubclassOf<UItem>();
+		return ItemClass ? ItemClass->GetDefaultObject<UItem>()->PickupMesh : nullptr;
+	};
+
+	//the meshes whose instances need redoing, only the ones the changes use if we know what changed
+	TSet<UStaticMesh*> DirtyMeshes;
+
+	if (ChangedEntries)
+	{
+		for (const LootBaseline::FEntry& Entry : *ChangedEntries)
+		{
+			DirtyMeshes.Add(GetEntryMesh(Entry));
+		}
+	}
+	else
+	{
+		for (const TPair<UStaticMesh*, UInstancedStaticMeshComponent*>& Proxy : Region->Proxies)
+		{
+			DirtyMeshes.Add(Proxy.Key);
+		}
+
+		for (const LootBaseline::FEntry& Entry : Region->Entries)
+		{
+			DirtyMeshes.Add(GetEntryMesh(Entry));
+		}
+	}
+
+	DirtyMeshes.Remove(nullptr);
+
+	for (UStaticMesh* Mesh : DirtyMeshes)
+	{
+		if (UInstancedStaticMeshComponent** Proxy = Region->Proxies.Find(Mesh))
+		{
+			if (*Proxy)
+			{
+				(*Proxy)->ClearInstances();
+			}
+		}
+	}
+
+	//one instanced component per mesh, so a whole region of loot is a handful of draw calls
+	for (const LootBaseline::FEntry& Entry : Region->Entries)
+	{
+		UStaticMesh* Mesh = GetEntryMesh(Entry);
+
+		if (!Mesh || !DirtyMeshes.Contains(Mesh))
+		{
+			continue;
+		}
+
+		UInstancedStaticMeshComponent*& Proxy = Region->Proxies.FindOrAdd(Mesh);
+
+		if (!Proxy)
+		{
+			Proxy = NewObject<UInstancedStaticMeshComponent>(this);
+			Proxy->SetStaticMesh(Mesh);
+			Proxy->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+			Proxy->SetMobility(EComponentMobility::Static);
+			Proxy->RegisterComponent();
+		}
+
+		Proxy->AddInstanceWorldSpace(Entry.Transform);
+	}
+
+	//a mesh nothing in the region uses anymore
+	for (UStaticMesh* Mesh : DirtyMeshes)
+	{
+		UInstancedStaticMeshComponent** Proxy = Region->Proxies.Find(Mesh);
+
+		if (Proxy && (!*Proxy || (*Proxy)->GetInstanceCount() == 0))
+		{
+			if (*Proxy)
+			{
+				(*Proxy)->DestroyComponent();
+			}
+
+			Region->Proxies.Remove(Mesh);
+		}
+	}
+
+	UpdateLootProxyVisibility();
+}
+
+void ASurvivalGameStateBase::UpdateLootProxyVisibility()
+{
+	APlayerController* PC = GetWorld()->GetFirstPlayerController();
+
+	if (!PC)
+	{
+		return;
+	}
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	const float ActivationDistanceSq = FMath::Square(LootActivationDistance);
+
+	for (const TPair<int32, FClientRegionLoot>& Region : ClientRegions)
+	{
+		//close enough that the real pickups are being replicated to us, so don't draw them twice
+		const bool bShowProxies = Region.Value.Bounds.ComputeSquaredDistanceToPoint(ViewLocation) > ActivationDistanceSq;
+
+		for (const TPair<UStaticMesh*, UInstancedStaticMeshComponent*>& Proxy : Region.Value.Proxies)
+		{
+			if (Proxy.Value && Proxy.Value->IsVisible() != bShowProxies)
+			{
+				Proxy.Value->SetVisibility(bShowProxies);
+			}
+		}
+	}
+}
@@ -4,14 +4,138 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameStateBase.h"
+#include "World/LootBaseline.h"
 #include "SurvivalGameStateBase.generated.h"
 
 /**
- * 
+ * Sends joining players the loot lying around the world as a compressed baseline per loot region, streamed a chunk at a time
+ * nearest region first, rather than as hundreds of pickup actor channels all opening at login. After that a region that changes only
+ * sends what was added and removed, to the players who already have it, and their proxies are updated rather than rebuilt.
+ * Regions far from every player are kept as data on the server and only drawn as instanced meshes on clients. The loot spawner
+ * spins up real pickup actors for a region once a player gets within LootActivationDistance of it.
  */
 UCLASS()
 class SURVIVALGAME_API ASurvivalGameStateBase : public AGameStateBase
 {
 	GENERATED_BODY()
-	
+
+public:
+
+	ASurvivalGameStateBase();
+
+	//Players closer than this to a loot region get real pickup actors for it. Should match the pickups net cull distance, as
+	//clients draw the baseline instead of the actors past this distance
+	UPROPERTY(EditDefaultsOnly, Category = "Loot Baseline", meta = (ClampMin = 0.0))
+	float LootActivationDistance;
+
+	//How far past LootActivationDistance everyone needs to be before a region goes back to being data. Stops regions flickering on and off at the edge
+	UPROPERTY(EditDefaultsOnly, Category = "Loot Baseline", meta = (ClampMin = 0.0))
+	float LootDeactivationMargin;
+
+	//The most baseline data we'll send each player per second, so joining doesn't spike their bandwidth
+	UPROPERTY(EditDefaultsOnly, Category = "Loot Baseline", meta = (ClampMin = 1))
+	int32 MaxBaselineBytesPerSecond;
+
+	//Baselines are split into chunks of this many bytes, one RPC each
+	UPROPERTY(EditDefaultsOnly, Category = "Loot Baseline", meta = (ClampMin = 64))
+	int32 BaselineChunkSize;
+
+	//[Server] What's in a region now. Anything that changed since last time is sent as a delta to anyone who already has the region
+	void UpdateLootRegion(const int32 RegionIndex, const FBox& Bounds, const TArray<LootBaseline::FEntry>& Entries);
+
+	//[Server] The id a loot item class is sent as
+	uint16 GetLootItemId(TSubclassOf<class UItem> ItemClass);
+
+	//[Server] Start sending a player every regions baseline, closest to them first
+	void StartLootBaselineStream(class APlayerController* PlayerController);
+
+	//[Client] One chunk of a regions baseline arrived. BaseVersion is zero for a whole baseline, otherwise it's a delta on top of that version
+	void ReceiveLootBaselineChunk(const int32 RegionIndex, const int32 BaseVersion, const int32 Version, const int32 ChunkIndex, const int32 NumChunks, const int32 UncompressedSize, const TArray<uint8>& Data);
+
+protected:
+
+	virtual void BeginPlay() override;
+	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
+
+	//Every item class that appears in a baseline. An items id is its index plus one
+	UPROPERTY(ReplicatedUsing = OnRep_LootItemClasses)
+	TArray<TSubclassOf<class UItem>> LootItemClasses;
+
+	//A baseline can arrive before the item classes it uses, so rebuild the proxies when they turn up
+	UFUNCTION()
+	void OnRep_LootItemClasses();
+
+	//[Server] Send the next few chunks to every player still streaming
+	void StreamLootBaselines();
+
+	//[Client] Draw a regions loot as instanced meshes, from the entries we have for it. With ChangedEntries only the meshes those
+	//use are refilled, the rest of the region's proxies are left alone
+	void UpdateLootProxies(const int32 RegionIndex, const TArray<LootBaseline::FEntry>* ChangedEntries = nullptr);
+
+	//[Client] Hide the proxies of regions close enough that the server is sending us the real pickups
+	void UpdateLootProxyVisibility();
+
+	//The change from Version - 1 to Version
+	struct FRegionDelta
+	{
+		int32 Version = 0;
+		TArray<uint8> Data;
+		int32 UncompressedSize = 0;
+	};
+
+	struct FServerRegionBaseline
+	{
+		FBox Bounds = FBox(ForceInit);
+		//The entries in the order clients have them, which deltas index into
+		TArray<LootBaseline::FEntry> Entries;
+		TArray<uint8> Data;
+		int32 UncompressedSize = 0;
+		//Bumped every time the region changes
+		int32 Version = 0;
+		//The last few changes, oldest first. Anyone further behind than these gets the whole baseline again
+		TArray<FRegionDelta> Deltas;
+	};
+
+	//[Server] The current baseline for every region
+	TArray<FServerRegionBaseline> ServerRegions;
+
+	struct FBaselineStream
+	{
+		TWeakObjectPtr<class APlayerController> PlayerController;
+		//Regions still to send, closest first
+		TArray<int32> RegionQueue;
+		//The chunk of the front region we're up to, and which version of it those chunks came from. SendingBaseVersion is
+		//the version a delta being sent goes on top of, zero when it's the whole baseline
+		int32 NextChunk = 0;
+		int32 SendingVersion = 0;
+		int32 SendingBaseVersion = 0;
+		//Which version of each region the player has been sent
+		TArray<int32> SentVersions;
+	};
+
+	TArray<FBaselineStream> Streams;
+
+	struct FClientRegionLoot
+	{
+		FBox Bounds = FBox(ForceInit);
+		TArray<LootBaseline::FEntry> Entries;
+		//The version Entries are from, zero until we've had a whole baseline
+		int32 Version = 0;
+
+		//Chunks of a newer version, or of a delta to it, that are still arriving
+		int32 IncomingVersion = INDEX_NONE;
+		int32 IncomingBaseVersion = 0;
+		TArray<uint8> IncomingData;
+		int32 IncomingChunks = 0;
+
+		//One instanced component per mesh
+		TMap<class UStaticMesh*, class UInstancedStaticMeshComponent*> Proxies;
+	};
+
+	//[Client] What we know about every region
+	TMap<int32, FClientRegionLoot> ClientRegions;
+
+	FTimerHandle TimerHandle_StreamBaselines;
+	FTimerHandle TimerHandle_ProxyVisibility;
+
 };
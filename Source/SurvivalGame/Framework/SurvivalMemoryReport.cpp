@@ -0,0 +1,254 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SurvivalMemoryReport.h"
+#include "Framework/SurvivalGameGameModeBase.h"
+#include "Components/InteractionComponent.h"
+#include "Components/InventoryComponent.h"
+#include "Components/LootSpawnerComponent.h"
+#include "World/Pickup.h"
+#include "Items/Item.h"
+#include "Blueprint/UserWidget.h"
+#include "Blueprint/WidgetTree.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "UObject/UObjectIterator.h"
+
+namespace SurvivalMemory
+{
+	static FThreadSafeCounter CurrentCounts[(int32)ECategory::MAX];
+	static volatile int32 PeakCounts[(int32)ECategory::MAX];
+
+	//bytes can only be counted by going through everything, so this is the peak of the reports run so far
+	static SIZE_T PeakBytes[(int32)ECategory::MAX];
+
+	static const TCHAR* CategoryNames[] = { TEXT("Items"), TEXT("Inventories"), TEXT("Interactables"), TEXT("Pickups") };
+
+	static bool ShouldTrack(const UObject* Object)
+	{
+		return !Object->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject);
+	}
+
+	struct FMemoryLine
+	{
+		int32 Count = 0;
+		SIZE_T Bytes = 0;
+
+		void Add(const SIZE_T InBytes)
+		{
+			++Count;
+			Bytes += InBytes;
+		}
+	};
+
+	struct FCategoryReport
+	{
+		FMemoryLine Total;
+		TMap<FString, FMemoryLine> ByClass;
+		TMap<FString, FMemoryLine> ByRegion;
+
+		void Add(const FString& ClassName, const FString& RegionName, const SIZE_T Bytes)
+		{
+			Total.Add(Bytes);
+			ByClass.FindOrAdd(ClassName).Add(Bytes);
+			ByRegion.FindOrAdd(RegionName).Add(Bytes);
+		}
+	};
+
+	//the object itself and any resources it owns, like the obj list command counts them
+	static SIZE_T GetObjectBytes(const UObject* Object)
+	{
+		return Object ? Object->GetClass()->GetStructureSize() + Object->GetResourceSizeBytes(EResourceSizeMode::Exclusive) : 0;
+	}
+
+	//the user widget and every widget in its tree. The Slate widgets behind them are in the UI llm tag instead
+	static SIZE_T GetWidgetBytes(UUserWidget* Widget)
+	{
+		SIZE_T Bytes = GetObjectBytes(Widget);
+
+		if (Widget && Widget->WidgetTree)
+		{
+			Bytes += GetObjectBytes(Widget->WidgetTree);
+			Widget->WidgetTree->ForEachWidget([&Bytes](UWidget* Child) { Bytes += GetObjectBytes(Child); });
+		}
+
+		return Bytes;
+	}
+
+	static FString GetRegionName(const ULootSpawnerComponent* LootSpawner, const AActor* Actor)
+	{
+		if (!Actor)
+		{
+			return TEXT("None");
+		}
+
+		//only the server has the loot spawner
+		if (LootSpawner)
+		{
+			const FVector Location = Actor->GetActorLocation();
+
+			for (int32 RegionIndex = 0; RegionIndex < LootSpawner->Regions.Num(); ++RegionIndex)
+			{
+				if (LootSpawner->Regions[RegionIndex].Bounds.IsInside(Location))
+				{
+					return FString::Printf(TEXT("Region %d"), RegionIndex);
+				}
+			}
+		}
+
+		return TEXT("Outside regions");
+	}
+
+	static void LogLines(FOutputDevice& Ar, const TCHAR* Heading, const TMap<FString, FMemoryLine>& Lines)
+	{
+		TArray<TPair<FString, FMemoryLine>> Sorted;
+		for (const TPair<FString, FMemoryLine>& Line : Lines)
+		{
+			Sorted.Add(Line);
+		}
+
+		Sorted.Sort([](const TPair<FString, FMemoryLine>& A, const TPair<FString, FMemoryLine>& B) { return A.Value.Bytes > B.Value.Bytes; });
+
+		Ar.Logf(TEXT("    %s:"), Heading);
+
+		for (const TPair<FString, FMemoryLine>& Line : Sorted)
+		{
+			Ar.Logf(TEXT("      %-40s %8d %10.1f KB"), *Line.Key, Line.Value.Count, Line.Value.Bytes / 1024.f);
+		}
+	}
+}
+
+void SurvivalMemory::TrackCreated(const UObject* Object, const ECategory Category)
+{
+	if (!ShouldTrack(Object))
+	{
+		return;
+	}
+
+	const int32 Count = CurrentCounts[(int32)Category].Increment();
+
+	//can be created on the loading thread, so raise the peak without locking
+	int32 Peak = PeakCounts[(int32)Category];
+	while (Count > Peak)
+	{
+		const int32 Previous = FPlatformAtomics::InterlockedCompareExchange(&PeakCounts[(int32)Category], Count, Peak);
+
+		if (Previous == Peak)
+		{
+			break;
+		}
+
+		Peak = Previous;
+	}
+}
+
+void SurvivalMemory::TrackDestroyed(const UObject* Object, const ECategory Category)
+{
+	if (ShouldTrack(Object))
+	{
+		CurrentCounts[(int32)Category].Decrement();
+	}
+}
+
+static void ReportMemory(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+{
+	using namespace SurvivalMemory;
+
+	if (!World)
+	{
+		return;
+	}
+
+	ASurvivalGameGameModeBase* GameMode = World->GetAuthGameMode<ASurvivalGameGameModeBase>();
+	const ULootSpawnerComponent* LootSpawner = GameMode ? GameMode->LootSpawner : nullptr;
+
+	FCategoryReport Reports[(int32)ECategory::MAX];
+
+	for (TObjectIterator<UItem> It; It; ++It)
+	{
+		UItem* Item = *It;
+		AActor* OwningActor = Item->GetTypedOuter<AActor>();
+
+		if (!ShouldTrack(Item) || !OwningActor || OwningActor->GetWorld() != World)
+		{
+			continue;
+		}
+
+		//items are either in an inventory, lying in the world in a pickup, or a template on their way into one of those
+		const FString RegionName = Item->OwningInventory ? TEXT("In inventories") : Cast<APickup>(OwningActor) ? GetRegionName(LootSpawner, OwningActor) : TEXT("Other");
+		Reports[(int32)ECategory::Items].Add(Item->GetClass()->GetName(), RegionName, GetObjectBytes(Item));
+	}
+
+	for (TObjectIterator<UInventoryComponent> It; It; ++It)
+	{
+		UInventoryComponent* Inventory = *It;
+
+		if (ShouldTrack(Inventory) && Inventory->GetWorld() == World)
+		{
+			Reports[(int32)ECategory::Inventories].Add(Inventory->GetOwner()->GetClass()->GetName(), GetRegionName(LootSpawner, Inventory->GetOwner()), GetObjectBytes(Inventory) + Inventory->GetStorageSize());
+		}
+	}
+
+	for (TObjectIterator<UInteractionComponent> It; It; ++It)
+	{
+		UInteractionComponent* Interactable = *It;
+
+		if (ShouldTrack(Interactable) && Interactable->GetWorld() == World)
+		{
+			Reports[(int32)ECategory::Interactables].Add(Interactable->GetOwner()->GetClass()->GetName(), GetRegionName(LootSpawner, Interactable->GetOwner()), GetObjectBytes(Interactable) + GetWidgetBytes(Interactable->GetUserWidgetObject()));
+		}
+	}
+
+	for (TActorIterator<APickup> It(World); It; ++It)
+	{
+		APickup* Pickup = *It;
+
+		//the interaction component and item are counted under their own categories
+		SIZE_T Bytes = GetObjectBytes(Pickup);
+		for (UActorComponent* Component : Pickup->GetComponents())
+		{
+			if (!Cast<UInteractionComponent>(Component))
+			{
+				Bytes += GetObjectBytes(Component);
+			}
+		}
+
+		Reports[(int32)ECategory::Pickups].Add(Pickup->GetClass()->GetName(), GetRegionName(LootSpawner, Pickup), Bytes);
+	}
+
+	Ar.Logf(TEXT("Survival memory report for %s"), *World->GetMapName());
+
+	for (int32 Category = 0; Category < (int32)ECategory::MAX; ++Category)
+	{
+		const FCategoryReport& Report = Reports[Category];
+		PeakBytes[Category] = FMath::Max(PeakBytes[Category], Report.Total.Bytes);
+
+		Ar.Logf(TEXT("  %s: %d (%d alive, peak %d), %.1f KB (peak %.1f KB)"), CategoryNames[Category], Report.Total.Count,
+			CurrentCounts[Category].GetValue(), PeakCounts[Category], Report.Total.Bytes / 1024.f, PeakBytes[Category] / 1024.f);
+
+		LogLines(Ar, TEXT("By class"), Report.ByClass);
+		LogLines(Ar, TEXT("By region"), Report.ByRegion);
+	}
+
+	//loot in regions nobody is near is data, not objects
+	if (LootSpawner)
+	{
+		Ar.Logf(TEXT("  Dormant loot:"));
+
+		for (int32 RegionIndex = 0; RegionIndex < LootSpawner->Regions.Num(); ++RegionIndex)
+		{
+			int32 Count = 0;
+			SIZE_T Bytes = 0;
+			LootSpawner->GetDormantLoot(RegionIndex, Count, Bytes);
+
+			Ar.Logf(TEXT("      Region %-33d %8d %10.1f KB"), RegionIndex, Count, Bytes / 1024.f);
+		}
+	}
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice ReportMemoryCommand(
+	TEXT("Survival.MemReport"),
+	TEXT("Reports counts and bytes of items, inventories, interactables and pickups, per class and per loot region, with peaks"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&ReportMemory));
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Counts of the objects world items are made of, kept up to date as they're created and destroyed so we know the peak as well as
+ * the current number. "Survival.MemReport" goes through them and reports counts and bytes per class and per loot region.
+ * Byte counts are the objects themselves and the containers they own. Engine side memory like physics bodies and
+ * Slate widgets isn't counted, -llm with the SurvivalGame tags covers those.
+ */
+namespace SurvivalMemory
+{
+	enum class ECategory : uint8
+	{
+		Items,
+		Inventories,
+		Interactables,
+		Pickups,
+		MAX
+	};
+
+	//Call from PostInitProperties and BeginDestroy. Class defaults and archetypes aren't counted
+	SURVIVALGAME_API void TrackCreated(const UObject* Object, const ECategory Category);
+	SURVIVALGAME_API void TrackDestroyed(const UObject* Object, const ECategory Category);
+}
@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SurvivalPerfCheck.h"
+#include "Misc/FileHelper.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+SurvivalPerfCheck::FRegressionCheck::FRegressionCheck(const TCHAR* InCheckName, const float InThresholdPercent)
+	: CheckName(InCheckName)
+	, ThresholdPercent(InThresholdPercent)
+	, NumRegressions(0)
+{
+}
+
+void SurvivalPerfCheck::FRegressionCheck::CheckMetric(const FString& Context, const TCHAR* MetricName, const double Value, const double BaselineValue, const double MinDifference)
+{
+	if (Value > BaselineValue * (1.0 + ThresholdPercent / 100.0) && Value - BaselineValue > MinDifference)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s regression in %s %s: %.4f, baseline %.4f (+%.1f%%)"), CheckName, *Context, MetricName, Value, BaselineValue,
+			BaselineValue > 0.0 ? (Value / BaselineValue - 1.0) * 100.0 : 100.0);
+		++NumRegressions;
+	}
+}
+
+TArray<FString> SurvivalPerfCheck::GetParams(const TArray<FString>& Args)
+{
+	TArray<FString> Params;
+	Params.Reserve(Args.Num());
+
+	for (const FString& Arg : Args)
+	{
+		Params.Add(Arg.StartsWith(TEXT("-")) ? Arg : TEXT("-") + Arg);
+	}
+
+	return Params;
+}
+
+bool SurvivalPerfCheck::SaveJson(const TSharedRef<FJsonObject>& Root, const FString& Path)
+{
+	FString Json;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+
+	if (!FJsonSerializer::Serialize(Root, Writer) || !FFileHelper::SaveStringToFile(Json, *Path))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Couldn't write results to %s"), *Path);
+		return false;
+	}
+
+	return true;
+}
+
+TSharedPtr<FJsonObject> SurvivalPerfCheck::LoadJson(const FString& Path)
+{
+	FString Json;
+	if (Path.IsEmpty() || !FFileHelper::LoadFileToString(Json, *Path))
+	{
+		return nullptr;
+	}
+
+	TSharedPtr<FJsonObject> Root;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Json);
+
+	if (!FJsonSerializer::Deserialize(Reader, Root) || !Root.IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s isn't valid json"), *Path);
+		return nullptr;
+	}
+
+	return Root;
+}
+
+void SurvivalPerfCheck::RequestExit(const bool bFailed)
+{
+	FPlatformMisc::RequestExitWithStatus(false, bFailed ? 1 : 0);
+}
@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FJsonObject;
+
+/**
+ * What the performance checks (Survival.RunBenchmarks and Survival.ReplayInteractions) share: reading their console args,
+ * writing and reading result json, deciding what counts as a regression against a baseline, and quitting with an exit code
+ * a ci job can fail on.
+ */
+namespace SurvivalPerfCheck
+{
+	//Differences smaller than these are noise, not regressions, however big they are in percent. Frame and GC times are whole
+	//milliseconds, a single interaction check takes microseconds
+	static const double MinFrameRegressionMs = 0.1;
+	static const double MinCallRegressionMs = 0.005;
+	static const double MinRegressionMB = 1.0;
+
+	//Counts the metrics that got worse than their baseline by more than ThresholdPercent
+	struct SURVIVALGAME_API FRegressionCheck
+	{
+		FRegressionCheck(const TCHAR* InCheckName, const float InThresholdPercent);
+
+		//Logs an error and counts it if Value is worse than BaselineValue by more than the threshold and by more than MinDifference
+		void CheckMetric(const FString& Context, const TCHAR* MetricName, const double Value, const double BaselineValue, const double MinDifference);
+
+		const TCHAR* CheckName;
+		float ThresholdPercent;
+		int32 NumRegressions;
+	};
+
+	//Console args come in as Key=Value, FParse wants -Key=Value
+	SURVIVALGAME_API TArray<FString> GetParams(const TArray<FString>& Args);
+
+	//Write Root to Path, logging an error if we can't
+	SURVIVALGAME_API bool SaveJson(const TSharedRef<FJsonObject>& Root, const FString& Path);
+
+	//Read the json at Path. Null if there's no file, or an error is logged if it isn't valid json
+	SURVIVALGAME_API TSharedPtr<FJsonObject> LoadJson(const FString& Path);
+
+	//Quit once a check is done, with a non-zero exit code if it failed
+	SURVIVALGAME_API void RequestExit(const bool bFailed);
+}
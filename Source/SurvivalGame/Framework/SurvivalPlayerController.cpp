@@ -2,4 +2,120 @@
 
 
 #include "SurvivalPlayerController.h"
+#include "Framework/SurvivalSignificanceManager.h"
+#include "Framework/SurvivalGameStateBase.h"
+#include "Components/LoadTestMonitorComponent.h"
+#include "Player/SurvivalBotComponent.h"
+#include "Engine/World.h"
+
+ASurvivalPlayerController::ASurvivalPlayerController()
+{
+	bUsingGamepad = false;
+}
+
+void ASurvivalPlayerController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (IsLocalController() && FParse::Param(FCommandLine::Get(), TEXT("SurvivalBot")))
+	{
+		USurvivalBotComponent* Bot = NewObject<USurvivalBotComponent>(this, TEXT("SurvivalBot"));
+		Bot->RegisterComponent();
+	}
+}
+
+bool ASurvivalPlayerController::InputKey(FKey Key, EInputEvent EventType, float AmountDepressed, bool bGamepad)
+{
+	if (EventType == IE_Pressed)
+	{
+		SetUsingGamepad(Key.IsGamepadKey());
+	}
+
+	return Super::InputKey(Key, EventType, AmountDepressed, bGamepad);
+}
+
+bool ASurvivalPlayerController::InputAxis(FKey Key, float Delta, float DeltaTime, int32 NumSamples, bool bGamepad)
+{
+	//sticks drift a little at rest, so only count a proper push as switching to the gamepad
+	if (FMath::Abs(Delta) > 0.25f)
+	{
+		SetUsingGamepad(Key.IsGamepadKey());
+	}
+
+	return Super::InputAxis(Key, Delta, DeltaTime, NumSamples, bGamepad);
+}
+
+void ASurvivalPlayerController::SetUsingGamepad(const bool bNewUsingGamepad)
+{
+	if (bUsingGamepad != bNewUsingGamepad)
+	{
+		bUsingGamepad = bNewUsingGamepad;
+
+		if (!HasAuthority())
+		{
+			ServerSetUsingGamepad(bNewUsingGamepad);
+		}
+	}
+}
+
+void ASurvivalPlayerController::ServerSetUsingGamepad_Implementation(const bool bNewUsingGamepad)
+{
+	ULoadTestMonitorComponent::RecordServerRPC(this);
+
+	bUsingGamepad = bNewUsingGamepad;
+}
+
+bool ASurvivalPlayerController::ServerSetUsingGamepad_Validate(const bool bNewUsingGamepad)
+{
+	return true;
+}
+
+void ASurvivalPlayerController::ClientReceiveLootBaseline_Implementation(const int32 RegionIndex, const int32 BaseVersion, const int32 Version, const int32 ChunkIndex, const int32 NumChunks, const int32 UncompressedSize, const TArray<uint8>& Data)
+{
+	ASurvivalGameStateBase* SurvivalGameState = GetWorld()->GetGameState<ASurvivalGameStateBase>();
+
+	//keep chunks in order, anything still waiting has to go first
+	if (SurvivalGameState && PendingLootBaselineChunks.Num() == 0)
+	{
+		SurvivalGameState->ReceiveLootBaselineChunk(RegionIndex, BaseVersion, Version, ChunkIndex, NumChunks, UncompressedSize, Data);
+		return;
+	}
+
+	PendingLootBaselineChunks.Add({ RegionIndex, BaseVersion, Version, ChunkIndex, NumChunks, UncompressedSize, Data });
+	DeliverLootBaselineChunks();
+}
+
+void ASurvivalPlayerController::DeliverLootBaselineChunks()
+{
+	ASurvivalGameStateBase* SurvivalGameState = GetWorld()->GetGameState<ASurvivalGameStateBase>();
+
+	if (!SurvivalGameState)
+	{
+		return;
+	}
+
+	for (const FLootBaselineChunk& Chunk : PendingLootBaselineChunks)
+	{
+		SurvivalGameState->ReceiveLootBaselineChunk(Chunk.RegionIndex, Chunk.BaseVersion, Chunk.Version, Chunk.ChunkIndex, Chunk.NumChunks, Chunk.UncompressedSize, Chunk.Data);
+	}
+
+	PendingLootBaselineChunks.Empty();
+}
+
+void ASurvivalPlayerController::PlayerTick(float DeltaTime)
+{
+	Super::PlayerTick(DeltaTime);
+
+	if (USurvivalSignificanceManager* SignificanceManager = USignificanceManager::Get<USurvivalSignificanceManager>(GetWorld()))
+	{
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+		TArray<FTransform, TInlineAllocator<1>> Viewpoints;
+		Viewpoints.Emplace(ViewRotation, ViewLocation, FVector::OneVector);
+
+		SignificanceManager->Update(Viewpoints);
+	}
+}
 
@@ -13,5 +13,54 @@ UCLASS()
 class SURVIVALGAME_API ASurvivalPlayerController : public APlayerController
 {
 	GENERATED_BODY()
+
+public:
+
+	ASurvivalPlayerController();
+
+	//Whether the player is on a gamepad right now, going by the last input we got. Known on the server too
+	FORCEINLINE bool IsUsingGamepad() const { return bUsingGamepad; }
+
+	//One chunk of a loot regions baseline, streamed to us by the game state after we join. With a BaseVersion it's only what
+	//changed since that version
+	UFUNCTION(Client, Reliable)
+	void ClientReceiveLootBaseline(const int32 RegionIndex, const int32 BaseVersion, const int32 Version, const int32 ChunkIndex, const int32 NumChunks, const int32 UncompressedSize, const TArray<uint8>& Data);
+
+	//[Client] Hand any chunks that got here before the game state did over to it. Called by the game state once it's replicated
+	void DeliverLootBaselineChunks();
+
+protected:
+
+	//Starts the load test bot when the client was launched with -SurvivalBot
+	virtual void BeginPlay() override;
+
+	virtual bool InputKey(FKey Key, EInputEvent EventType, float AmountDepressed, bool bGamepad) override;
+	virtual bool InputAxis(FKey Key, float Delta, float DeltaTime, int32 NumSamples, bool bGamepad) override;
+
+	//Switch input device, telling the server if it changed
+	void SetUsingGamepad(const bool bNewUsingGamepad);
+
+	//The server runs its own interaction check, so it needs to know which assist settings the player is using
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerSetUsingGamepad(const bool bNewUsingGamepad);
+
+	bool bUsingGamepad;
+
+	struct FLootBaselineChunk
+	{
+		int32 RegionIndex;
+		int32 BaseVersion;
+		int32 Version;
+		int32 ChunkIndex;
+		int32 NumChunks;
+		int32 UncompressedSize;
+		TArray<uint8> Data;
+	};
+
+	//[Client] Chunks that arrived before the game state. The server won't send them again, and later chunks are useless without them
+	TArray<FLootBaselineChunk> PendingLootBaselineChunks;
+
+	//Only runs for local player controllers. Feeds our camera into the significance manager so it can score remote characters
+	virtual void PlayerTick(float DeltaTime) override;
 	
 };
@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SurvivalSignificanceManager.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Player/SurvivalCharacter.h"
+
+const FName USurvivalSignificanceManager::CharacterTag(TEXT("SurvivalCharacter"));
+
+USurvivalSignificanceManager::USurvivalSignificanceManager()
+{
+	//server has no viewpoint to score characters against, so it doesnt need a manager
+	bCreateOnServer = false;
+
+	FullRateDistance = 1500.f;
+	CullDistance = 8000.f;
+	HighScreenSize = 0.1f;
+	MediumScreenSize = 0.03f;
+	VisibilityTolerance = 0.25f;
+	MediumTickInterval = 1.f / 20.f;
+	LowTickInterval = 1.f / 5.f;
+}
+
+void USurvivalSignificanceManager::RegisterCharacter(ASurvivalCharacter* Character)
+{
+	if (!Character)
+	{
+		return;
+	}
+
+	auto SignificanceFunction = [this](const FManagedObjectInfo* ObjectInfo, const FTransform& Viewpoint)
+	{
+		return CalculateCharacterSignificance(ObjectInfo, Viewpoint);
+	};
+
+	auto PostSignificanceFunction = [this](FManagedObjectInfo* ObjectInfo, float OldSignificance, float Significance, bool bFinal)
+	{
+		OnCharacterSignificanceChanged(ObjectInfo, OldSignificance, Significance, bFinal);
+	};
+
+	RegisterObject(Character, CharacterTag, SignificanceFunction, EPostSignificanceType::Sequential, PostSignificanceFunction);
+
+	//registering scores the character straight away, but the post function only fires on a change, so apply the first bucket ourselves
+	ApplySignificance(Character, (ECharacterSignificance)FMath::RoundToInt(GetSignificance(Character)));
+}
+
+void USurvivalSignificanceManager::UnregisterCharacter(ASurvivalCharacter* Character)
+{
+	if (Character)
+	{
+		UnregisterObject(Character);
+	}
+}
+
+float USurvivalSignificanceManager::CalculateCharacterSignificance(const FManagedObjectInfo* ObjectInfo, const FTransform& Viewpoint) const
+{
+	const ASurvivalCharacter* Character = Cast<ASurvivalCharacter>(ObjectInfo->GetObject());
+
+	//our own character always runs at full rate
+	if (!Character || Character->IsLocallyControlled())
+	{
+		return (float)ECharacterSignificance::CS_High;
+	}
+
+	const float Distance = FVector::Dist(Viewpoint.GetLocation(), Character->GetActorLocation());
+
+	if (Distance <= FullRateDistance)
+	{
+		return (float)ECharacterSignificance::CS_High;
+	}
+
+	//offscreen characters stay ticking slowly while nearby so they don't pop when we turn around, and stop altogether when far away
+	if (!Character->WasRecentlyRendered(VisibilityTolerance))
+	{
+		return (float)(Distance > CullDistance ? ECharacterSignificance::CS_Culled : ECharacterSignificance::CS_Low);
+	}
+
+	//rough fraction of the screen the character takes up, bounds radius over distance
+	const float ScreenSize = Character->GetMesh()->Bounds.SphereRadius / Distance;
+
+	if (ScreenSize >= HighScreenSize)
+	{
+		return (float)ECharacterSignificance::CS_High;
+	}
+
+	return (float)(ScreenSize >= MediumScreenSize ? ECharacterSignificance::CS_Medium : ECharacterSignificance::CS_Low);
+}
+
+void USurvivalSignificanceManager::OnCharacterSignificanceChanged(FManagedObjectInfo* ObjectInfo, float OldSignificance, float Significance, bool bFinal) const
+{
+	ASurvivalCharacter* Character = Cast<ASurvivalCharacter>(ObjectInfo->GetObject());
+
+	if (!Character)
+	{
+		return;
+	}
+
+	//when the character is unregistered, put it back to full rate so nothing is left throttled
+	if (bFinal)
+	{
+		ApplySignificance(Character, ECharacterSignificance::CS_High);
+		return;
+	}
+
+	const ECharacterSignificance OldBucket = (ECharacterSignificance)FMath::RoundToInt(OldSignificance);
+	const ECharacterSignificance NewBucket = (ECharacterSignificance)FMath::RoundToInt(Significance);
+
+	//this is called for every character every update, only touch tick functions when the bucket actually changes
+	if (OldBucket != NewBucket)
+	{
+		ApplySignificance(Character, NewBucket);
+	}
+}
+
+void USurvivalSignificanceManager::ApplySignificance(ASurvivalCharacter* Character, const ECharacterSignificance Significance) const
+{
+	const bool bShouldTick = Significance != ECharacterSignificance::CS_Culled;
+	const float TickInterval = GetTickIntervalForSignificance(Significance);
+
+	//the actor tick is left alone, remote characters don't check for interactables so it's already off
+
+	//body and all the gear meshes following its pose
+	TInlineComponentArray<USkeletalMeshComponent*> Meshes(Character);
+
+	for (USkeletalMeshComponent* Mesh : Meshes)
+	{
+		//empty gear components, e.g. ones whose gear has been merged into the body, stay switched off
+		if (!Mesh->SkeletalMesh)
+		{
+			continue;
+		}
+
+		Mesh->SetComponentTickEnabled(bShouldTick);
+		Mesh->SetComponentTickInterval(TickInterval);
+
+		//low significance characters only evaluate their pose if they actually get drawn
+		Mesh->VisibilityBasedAnimTickOption = Significance >= ECharacterSignificance::CS_Medium ? EVisibilityBasedAnimTickOption::AlwaysTickPose : EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+	}
+}
+
+float USurvivalSignificanceManager::GetTickIntervalForSignificance(const ECharacterSignificance Significance) const
+{
+	switch (Significance)
+	{
+	case ECharacterSignificance::CS_Medium:
+		return MediumTickInterval;
+	case ECharacterSignificance::CS_Low:
+	case ECharacterSignificance::CS_Culled:
+		return LowTickInterval;
+	default:
+		return 0.f;
+	}
+}
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SignificanceManager.h"
+#include "SurvivalSignificanceManager.generated.h"
+
+//How important a remote character is to the local player. Higher values tick more often.
+UENUM()
+enum class ECharacterSignificance : uint8
+{
+	CS_Culled UMETA(DisplayName = "Culled"),
+	CS_Low UMETA(DisplayName = "Low"),
+	CS_Medium UMETA(DisplayName = "Medium"),
+	CS_High UMETA(DisplayName = "High")
+};
+
+/**
+ * Scores remote characters by distance, visibility and screen size, and lowers their skeletal mesh update rates
+ * to match. Characters that are offscreen and far away stop ticking entirely.
+ * Only exists on clients, the dedicated server has no viewpoint to score against.
+ */
+UCLASS()
+class SURVIVALGAME_API USurvivalSignificanceManager : public USignificanceManager
+{
+	GENERATED_BODY()
+
+public:
+
+	USurvivalSignificanceManager();
+
+	//Tag all characters are registered under
+	static const FName CharacterTag;
+
+	void RegisterCharacter(class ASurvivalCharacter* Character);
+	void UnregisterCharacter(class ASurvivalCharacter* Character);
+
+protected:
+
+	//Characters closer than this always tick at full rate, even when offscreen, so they're ready when we turn around
+	UPROPERTY(Config)
+	float FullRateDistance;
+
+	//Offscreen characters further away than this stop ticking entirely
+	UPROPERTY(Config)
+	float CullDistance;
+
+	//Visible characters taking up at least this much of the screen tick at full rate
+	UPROPERTY(Config)
+	float HighScreenSize;
+
+	//Visible characters taking up at least this much of the screen tick at the medium rate, anything smaller is low
+	UPROPERTY(Config)
+	float MediumScreenSize;
+
+	//How long since a character was last rendered before we treat it as offscreen
+	UPROPERTY(Config)
+	float VisibilityTolerance;
+
+	//Mesh tick intervals in seconds for the medium and low significance buckets
+	UPROPERTY(Config)
+	float MediumTickInterval;
+
+	UPROPERTY(Config)
+	float LowTickInterval;
+
+	float CalculateCharacterSignificance(const FManagedObjectInfo* ObjectInfo, const FTransform& Viewpoint) const;
+	void OnCharacterSignificanceChanged(FManagedObjectInfo* ObjectInfo, float OldSignificance, float Significance, bool bFinal) const;
+
+	//Set the skeletal mesh tick rates for a character in the given bucket
+	void ApplySignificance(class ASurvivalCharacter* Character, const ECharacterSignificance Significance) const;
+
+	float GetTickIntervalForSignificance(const ECharacterSignificance Significance) const;
+
+};
@@ -0,0 +1,189 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SurvivalTickAudit.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "TimerManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Parse.h"
+#include "CoreGlobals.h"
+
+namespace SurvivalTickAudit
+{
+	bool bCapturing = false;
+
+	struct FTickLine
+	{
+		int32 Registered = 0;
+		int32 Enabled = 0;
+		float MinInterval = 0.f;
+		float MaxInterval = 0.f;
+		int64 Calls = 0;
+		uint64 Cycles = 0;
+	};
+
+	//calls and cycles per class from the capture in progress
+	static TMap<FName, FTickLine> CapturedTicks;
+
+	static FTimerHandle TimerHandle_Capture;
+	static TWeakObjectPtr<UWorld> CaptureWorld;
+	static uint64 CaptureStartFrame = 0;
+	static double CaptureStartTime = 0.0;
+
+	static const FName ModulePackageName(TEXT("/Script/SurvivalGame"));
+
+	//blueprints count as ours if the native class they're built on is
+	static bool IsFromModule(const UClass* Class)
+	{
+		while (Class && !Class->HasAnyClassFlags(CLASS_Native))
+		{
+			Class = Class->GetSuperClass();
+		}
+
+		return Class && Class->GetOutermost()->GetFName() == ModulePackageName;
+	}
+
+	static void AddTickFunction(TMap<FName, FTickLine>& Lines, const UObject* Object, const FTickFunction& TickFunction)
+	{
+		if (!TickFunction.bCanEverTick || !IsFromModule(Object->GetClass()))
+		{
+			return;
+		}
+
+		FTickLine& Line = Lines.FindOrAdd(Object->GetClass()->GetFName());
+
+		if (TickFunction.IsTickFunctionRegistered())
+		{
+			++Line.Registered;
+		}
+
+		if (TickFunction.IsTickFunctionEnabled())
+		{
+			Line.MinInterval = Line.Enabled > 0 ? FMath::Min(Line.MinInterval, TickFunction.TickInterval) : TickFunction.TickInterval;
+			Line.MaxInterval = FMath::Max(Line.MaxInterval, TickFunction.TickInterval);
+			++Line.Enabled;
+		}
+	}
+
+	//Seconds and Frames are how long the capture ran for, zero to list registrations only
+	static void LogReport(FOutputDevice& Ar, UWorld* World, const double Seconds, const uint64 Frames)
+	{
+		TMap<FName, FTickLine> Lines = CapturedTicks;
+
+		for (TActorIterator<AActor> It(World); It; ++It)
+		{
+			AActor* Actor = *It;
+			AddTickFunction(Lines, Actor, Actor->PrimaryActorTick);
+
+			for (UActorComponent* Component : Actor->GetComponents())
+			{
+				if (Component)
+				{
+					AddTickFunction(Lines, Component, Component->PrimaryComponentTick);
+				}
+			}
+		}
+
+		Lines.ValueSort([](const FTickLine& A, const FTickLine& B) { return A.Cycles != B.Cycles ? A.Cycles > B.Cycles : A.Registered > B.Registered; });
+
+		Ar.Logf(TEXT("Survival tick audit for %s"), *World->GetMapName());
+
+		if (Seconds > 0.0)
+		{
+			Ar.Logf(TEXT("  Captured %llu frames over %.1f seconds. Calls and time are only counted for ticks with a SURVIVAL_TICK_AUDIT_SCOPE"), Frames, Seconds);
+		}
+
+		Ar.Logf(TEXT("    %-40s %10s %8s %16s %10s %10s %10s %10s"), TEXT("Class"), TEXT("Registered"), TEXT("Enabled"), TEXT("Interval"), TEXT("Calls"), TEXT("Calls/s"), TEXT("Total ms"), TEXT("ms/frame"));
+
+		for (const TPair<FName, FTickLine>& Line : Lines)
+		{
+			const FTickLine& Tick = Line.Value;
+			const double TotalMs = FPlatformTime::ToMilliseconds64(Tick.Cycles);
+
+			const FString Interval = Tick.Enabled == 0 ? TEXT("-") : Tick.MinInterval == Tick.MaxInterval ? FString::Printf(TEXT("%.3f"), Tick.MinInterval) : FString::Printf(TEXT("%.3f-%.3f"), Tick.MinInterval, Tick.MaxInterval);
+
+			Ar.Logf(TEXT("    %-40s %10d %8d %16s %10lld %10.1f %10.3f %10.4f"), *Line.Key.ToString(), Tick.Registered, Tick.Enabled, *Interval, Tick.Calls,
+				Seconds > 0.0 ? Tick.Calls / Seconds : 0.0, TotalMs, Frames > 0 ? TotalMs / Frames : 0.0);
+		}
+	}
+
+	static void FinishCapture(TWeakObjectPtr<UWorld> World)
+	{
+		bCapturing = false;
+
+		if (World.IsValid())
+		{
+			LogReport(*GLog, World.Get(), FPlatformTime::Seconds() - CaptureStartTime, GFrameCounter - CaptureStartFrame);
+		}
+
+		CapturedTicks.Reset();
+	}
+}
+
+SurvivalTickAudit::FScope::FScope(const UObject* Object)
+	: StartCycles(0)
+{
+	//none of our ticks run off the game thread, but the capture map isn't safe if one ever does
+	if (bCapturing && IsInGameThread())
+	{
+		ClassName = Object->GetClass()->GetFName();
+		StartCycles = FPlatformTime::Cycles();
+	}
+}
+
+SurvivalTickAudit::FScope::~FScope()
+{
+	if (!ClassName.IsNone())
+	{
+		FTickLine& Line = CapturedTicks.FindOrAdd(ClassName);
+		++Line.Calls;
+		Line.Cycles += FPlatformTime::Cycles() - StartCycles;
+	}
+}
+
+static void AuditTicks(const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+{
+	using namespace SurvivalTickAudit;
+
+	if (!World)
+	{
+		return;
+	}
+
+	//a capture whose world went away before it finished never will
+	if (bCapturing && CaptureWorld.IsValid())
+	{
+		Ar.Logf(TEXT("A tick audit is already capturing."));
+		return;
+	}
+
+	float Seconds = 5.f;
+
+	for (const FString& Arg : Args)
+	{
+		const FString Param = Arg.StartsWith(TEXT("-")) ? Arg : TEXT("-") + Arg;
+		FParse::Value(*Param, TEXT("Seconds="), Seconds);
+	}
+
+	if (Seconds <= 0.f)
+	{
+		LogReport(Ar, World, 0.0, 0);
+		return;
+	}
+
+	CapturedTicks.Reset();
+	CaptureStartFrame = GFrameCounter;
+	CaptureStartTime = FPlatformTime::Seconds();
+	CaptureWorld = World;
+	bCapturing = true;
+
+	World->GetTimerManager().SetTimer(TimerHandle_Capture, FTimerDelegate::CreateStatic(&FinishCapture, TWeakObjectPtr<UWorld>(World)), Seconds, false);
+
+	Ar.Logf(TEXT("Capturing ticks for %.1f seconds, the report goes to the log."), Seconds);
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice AuditTicksCommand(
+	TEXT("Survival.TickAudit"),
+	TEXT("Lists registered SurvivalGame tick functions, then captures their calls and time. Args: Seconds=<n>, 0 just lists them"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic(&AuditTicks));
@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * "Survival.TickAudit [Seconds=<n>]" lists every actor and component tick function from SurvivalGame classes in the world, how many
+ * are registered and enabled and at what interval, then captures for a few seconds and reports how often each class ticked and
+ * how long it spent doing it. Only ticks with a SURVIVAL_TICK_AUDIT_SCOPE are timed, ones we don't override show up as registered
+ * with no calls, their time is the engines.
+ */
+namespace SurvivalTickAudit
+{
+	//True while an audit is capturing, so ticks outside of one only pay for this check
+	extern SURVIVALGAME_API bool bCapturing;
+
+	struct SURVIVALGAME_API FScope
+	{
+		FScope(const UObject* Object);
+		~FScope();
+
+	private:
+
+		FName ClassName;
+		uint32 StartCycles;
+	};
+}
+
+//Counts and times the rest of a Tick or TickComponent against the class of this, for Survival.TickAudit
+#define SURVIVAL_TICK_AUDIT_SCOPE() SurvivalTickAudit::FScope TickAuditScope(this)
@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ConsumableItem.h"
+#include "Components/InventoryComponent.h"
+#include "Player/SurvivalCharacter.h"
+
+#define LOCTEXT_NAMESPACE "ConsumableItem"
+
+UConsumableItem::UConsumableItem()
+{
+	UseActionText = LOCTEXT("ConsumableItemUseActionText", "Consume");
+}
+
+void UConsumableItem::Use(class ASurvivalCharacter* Character)
+{
+	UStatusEffectComponent* StatusEffects = UStatusEffectComponent::Get(Character);
+
+	if (!Character || !StatusEffects || !OwningInventory)
+	{
+		return;
+	}
+
+	StatusEffects->ApplyEffects(Character, Effects);
+
+	OwningInventory->ConsumeItem(this, 1);
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Items/Item.h"
+#include "Components/StatusEffectComponent.h"
+#include "ConsumableItem.generated.h"
+
+/**
+ * Food, medicine and buffs. Using one takes one off the stack and puts its effects on the character
+ */
+UCLASS(Abstract, Blueprintable)
+class SURVIVALGAME_API UConsumableItem : public UItem
+{
+	GENERATED_BODY()
+
+public:
+
+	UConsumableItem();
+
+	//What using this item does to whoever uses it. The status effect manager runs these, they never tick by themselves
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Consumable")
+	TArray<FStatusEffect> Effects;
+
+	virtual void Use(class ASurvivalCharacter* Character) override;
+};
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "CraftingRecipe.generated.h"
+
+//An item and how many of it a recipe uses up
+USTRUCT(BlueprintType)
+struct FCraftingIngredient
+{
+	GENERATED_BODY()
+
+	FCraftingIngredient()
+	{
+		Quantity = 1;
+	}
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Crafting")
+	TSubclassOf<class UItem> Item;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Crafting", meta = (ClampMin = 1))
+	int32 Quantity;
+};
+
+//A row in a recipe data table. The row name is how the recipe is referred to over the network
+USTRUCT(BlueprintType)
+struct FCraftingRecipe : public FTableRowBase
+{
+	GENERATED_BODY()
+
+	FCraftingRecipe()
+	{
+		ResultQuantity = 1;
+		CraftTime = 1.f;
+	}
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Crafting")
+	TArray<FCraftingIngredient> Ingredients;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Crafting")
+	TSubclassOf<class UItem> Result;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Crafting", meta = (ClampMin = 1))
+	int32 ResultQuantity;
+
+	//How long in seconds one craft of this recipe takes
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Crafting", meta = (ClampMin = 0.0))
+	float CraftTime;
+};
@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EquippableItem.h"
+#include "Components/EquipmentComponent.h"
+
+#define LOCTEXT_NAMESPACE "EquippableItem"
+
+UEquippableItem::UEquippableItem()
+{
+	//every piece of gear is its own thing, you can't wear a stack of helmets
+	bStackable = false;
+	UseActionText = LOCTEXT("EquippableItemUseActionText", "Equip");
+	Slot = EEquippableSlot::EIS_Helmet;
+	AnimateInTime = 0.f;
+}
+
+void UEquippableItem::Use(class ASurvivalCharacter* Character)
+{
+	if (Character && Character->PlayerEquipment)
+	{
+		Character->PlayerEquipment->EquipItem(GetClass());
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
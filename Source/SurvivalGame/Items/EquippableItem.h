@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Items/Item.h"
+#include "Player/SurvivalCharacter.h"
+#include "EquippableItem.generated.h"
+
+/**
+ * An item that can be worn in one of the characters gear slots. The mesh is a soft reference, so having the item in an
+ * inventory doesn't load it, the equipment component streams it in when it's equipped.
+ */
+UCLASS(Abstract, Blueprintable)
+class SURVIVALGAME_API UEquippableItem : public UItem
+{
+	GENERATED_BODY()
+
+public:
+
+	UEquippableItem();
+
+	//The slot this item is worn in
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Equippable")
+	EEquippableSlot Slot;
+
+	//The gear mesh shown on the character while this is equipped
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Equippable")
+	TSoftObjectPtr<class USkeletalMesh> Mesh;
+
+	//How long the gear is kept as its own component after it's put on, so it can animate in before it gets merged
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Equippable", meta = (ClampMin = 0.0))
+	float AnimateInTime;
+
+	//Puts the item on in its slot
+	virtual void Use(class ASurvivalCharacter* Character) override;
+};
@@ -3,6 +3,7 @@
 
 #include "Item.h"
 #include "Components/InventoryComponent.h"
+#include "Framework/SurvivalMemoryReport.h"
 #include "Net/UnrealNetwork.h"
 
 
@@ -50,6 +51,24 @@ UItem::UItem()
 	Quantity = 1;
 	MaxStackSize = 2; 
 	RepKey = 0; 
+	DecayInterval = 0.f;
+	DecayAmount = 1;
+	NextDecayTime = 0.f;
+	PredictedQuantity = 0;
+}
+
+void UItem::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	SurvivalMemory::TrackCreated(this, SurvivalMemory::ECategory::Items);
+}
+
+void UItem::BeginDestroy()
+{
+	SurvivalMemory::TrackDestroyed(this, SurvivalMemory::ECategory::Items);
+
+	Super::BeginDestroy();
 }
 
 void UItem::OnRep_Quantity()
@@ -62,8 +81,15 @@ void UItem::SetQuantity(const int32 NewQuantity)
 	if (NewQuantity != Quantity)
 	{
 		//clamp will set quantity to a max of the stackable amount, if not stackable then it will be set to 1
+		const int32 OldQuantity = Quantity;
 		Quantity = FMath::Clamp(NewQuantity, 0, bStackable ? MaxStackSize : 1);
 		MarkDirtyForReplication();
+
+		//lets anything keeping counts of the inventory, like crafting, update just this item instead of recounting everything
+		if (OwningInventory && Quantity != OldQuantity)
+		{
+			OwningInventory->OnItemQuantityChanged.Broadcast(this, Quantity - OldQuantity);
+		}
 	}
 }
 
@@ -72,7 +98,7 @@ bool UItem::ShouldShowInInventory() const
 	return true;
 }
 
-void UItem::Use(ASurivivalCharacter* Character)
+void UItem::Use(ASurvivalCharacter* Character)
 {
 }
 
@@ -82,6 +108,14 @@ void UItem::AddedToInventory(UInventoryComponent* Inventory)
 
 void UItem::MarkDirtyForReplication()
 {
+	//bumping the repkey tells the owning actor channel this item needs to be sent again
+	++RepKey;
+
+	//and the inventory needs to know one of its items changed, so it goes looking through them
+	if (OwningInventory)
+	{
+		++OwningInventory->ReplicatedItemsKey;
+	}
 }
 
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
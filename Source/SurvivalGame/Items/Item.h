@@ -31,6 +31,10 @@ protected:
 	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
 	virtual bool IsSupportedForNetworking() const override; 
 
+	//Counted for Survival.MemReport
+	virtual void PostInitProperties() override;
+	virtual void BeginDestroy() override;
+
 //dont want following function packaged with game, if WITH_EDITOR means it is only packaged/used in editor environment
 #if WITH_EDITOR
 	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override; 
@@ -74,6 +78,21 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item", meta = (ClamPin = 2, EditCondition = bStackable))
 	int32 MaxStackSize; 
 
+	// how often in seconds a perishable item loses DecayAmount from its stack, zero means it never decays
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item", meta = (ClampMin = 0.0))
+	float DecayInterval;
+
+	// how much of the stack is lost every DecayInterval
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item", meta = (ClampMin = 1))
+	int32 DecayAmount;
+
+	// [server] world time the next decay is due, used by the item lifecycle manager to spot stale entries. copied along with the item so moving it doesnt restart the clock
+	float NextDecayTime;
+
+	// [client] how much of this item the local player has picked up but the server hasnt confirmed yet. always zero on the server
+	// kept apart from Quantity so replication never fights with it, the inventory takes it off again when the server acks the pickup
+	int32 PredictedQuantity;
+
 	// the tooltip in the inenvtory for this item
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Item")
 	TSubclassOf<class UItemTooltip> ItemTooltip;
@@ -99,9 +118,12 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Item")
 	void SetQuantity(const int32 NewQuantity);
 
+	UFUNCTION(BlueprintPure, Category = "Item")
+	FORCEINLINE int32 GetQuantity() const { return Quantity + PredictedQuantity; }
+
 	// helper function that returns the weight of the sOtack 
 	UFUNCTION(BlueprintCallable, Category = "Intem")
-	FORCEINLINE float GetStackWeight() const { return Quantity * Weight; };
+	FORCEINLINE float GetStackWeight() const { return GetQuantity() * Weight; };
 
 	// certain items, such as clothing, shouldn't show up in the inventory after you equip them 
 	// this function gives us a way to implement that behavior 
@@ -110,7 +132,7 @@ public:
 
 	//every item is going to have a different use functionality -- food will heal, weapons will be wielded, etc
 	//this is why use function is marked as virtual
-	virtual void Use(class ASurivivalCharacter* Character);
+	virtual void Use(class ASurvivalCharacter* Character);
 	virtual void AddedToInventory(class UInventoryComponent* Inventory);
 
 	// mark the object as needing replication, we must call this internally after modifying any replicated properties
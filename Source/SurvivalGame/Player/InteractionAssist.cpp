@@ -0,0 +1,209 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InteractionAssist.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/RandomStream.h"
+
+void FInteractionAssistCandidates::Reset()
+{
+	X.Reset();
+	Y.Reset();
+	Z.Reset();
+	Radius.Reset();
+	ReachSq.Reset();
+	InvReachSq.Reset();
+	Priority.Reset();
+	Components.Reset();
+}
+
+void FInteractionAssistCandidates::Add(const FVector& Location, const float InRadius, const float Reach, const float InPriority, class UInteractionComponent* Component)
+{
+	X.Add(Location.X);
+	Y.Add(Location.Y);
+	Z.Add(Location.Z);
+	Radius.Add(InRadius);
+	ReachSq.Add(FMath::Square(Reach));
+	InvReachSq.Add(Reach > 0.f ? 1.f / FMath::Square(Reach) : 0.f);
+	Priority.Add(InPriority);
+	Components.Add(Component);
+}
+
+void FInteractionAssistCandidates::Pad()
+{
+	//a negative reach fails the range test whatever else is in the lane
+	while (X.Num() % 4 != 0)
+	{
+		X.Add(0.f);
+		Y.Add(0.f);
+		Z.Add(0.f);
+		Radius.Add(0.f);
+		ReachSq.Add(-1.f);
+		InvReachSq.Add(0.f);
+		Priority.Add(0.f);
+		Components.Add(nullptr);
+	}
+}
+
+int32 InteractionAssist::FindBestCandidate(const FInteractionAssistCandidates& Candidates, const FVector& ViewLocation, const FVector& ViewDirection, const FInteractionAssistSettings& Settings, FInteractionAssistCandidates::FFloatArray& OutScores)
+{
+	const int32 Num = Candidates.Num();
+	check(Num % 4 == 0);
+
+	OutScores.SetNumUninitialized(Num, false);
+
+	const VectorRegister EyeX = VectorSetFloat1(ViewLocation.X);
+	const VectorRegister EyeY = VectorSetFloat1(ViewLocation.Y);
+	const VectorRegister EyeZ = VectorSetFloat1(ViewLocation.Z);
+	const VectorRegister DirX = VectorSetFloat1(ViewDirection.X);
+	const VectorRegister DirY = VectorSetFloat1(ViewDirection.Y);
+	const VectorRegister DirZ = VectorSetFloat1(ViewDirection.Z);
+	const VectorRegister MinCos = VectorSetFloat1(FMath::Cos(FMath::DegreesToRadians(Settings.MaxAngle)));
+	const VectorRegister AngleWeight = VectorSetFloat1(Settings.AngleWeight);
+	const VectorRegister DistanceWeight = VectorSetFloat1(Settings.DistanceWeight);
+	const VectorRegister PriorityWeight = VectorSetFloat1(Settings.PriorityWeight);
+	const VectorRegister MinDistSq = VectorSetFloat1(KINDA_SMALL_NUMBER);
+	const VectorRegister NotPickable = VectorSetFloat1(-BIG_NUMBER);
+
+	for (int32 i = 0; i < Num; i += 4)
+	{
+		const VectorRegister DX = VectorSubtract(VectorLoadAligned(&Candidates.X[i]), EyeX);
+		const VectorRegister DY = VectorSubtract(VectorLoadAligned(&Candidates.Y[i]), EyeY);
+		const VectorRegister DZ = VectorSubtract(VectorLoadAligned(&Candidates.Z[i]), EyeZ);
+
+		const VectorRegister DistSq = VectorMultiplyAdd(DX, DX, VectorMultiplyAdd(DY, DY, VectorMultiply(DZ, DZ)));
+		const VectorRegister InvDist = VectorReciprocalSqrt(VectorMax(DistSq, MinDistSq));
+		const VectorRegister Along = VectorMultiplyAdd(DX, DirX, VectorMultiplyAdd(DY, DirY, VectorMultiply(DZ, DirZ)));
+
+		//bigger things are easier to aim at, so they get a bit of leeway on the angle
+		const VectorRegister Cos = VectorMin(VectorMultiply(VectorAdd(Along, VectorLoadAligned(&Candidates.Radius[i])), InvDist), VectorOne());
+
+		//one at the player, zero at the edge of the candidates reach
+		const VectorRegister Closeness = VectorSubtract(VectorOne(), VectorMultiply(DistSq, VectorLoadAligned(&Candidates.InvReachSq[i])));
+
+		VectorRegister Score = VectorMultiply(Cos, AngleWeight);
+		Score = VectorMultiplyAdd(Closeness, DistanceWeight, Score);
+		Score = VectorMultiplyAdd(VectorLoadAligned(&Candidates.Priority[i]), PriorityWeight, Score);
+
+		const VectorRegister InRange = VectorCompareGE(VectorLoadAligned(&Candidates.ReachSq[i]), DistSq);
+		const VectorRegister InCone = VectorCompareGE(Cos, MinCos);
+
+		VectorStoreAligned(VectorSelect(VectorBitwiseAnd(InRange, InCone), Score, NotPickable), &OutScores[i]);
+	}
+
+	int32 BestIndex = INDEX_NONE;
+	float BestScore = -BIG_NUMBER;
+
+	for (int32 i = 0; i < Num; ++i)
+	{
+		if (OutScores[i] > BestScore)
+		{
+			BestScore = OutScores[i];
+			BestIndex = i;
+		}
+	}
+
+	return BestIndex;
+}
+
+int32 InteractionAssist::FindBestCandidate_Scalar(const FInteractionAssistCandidates& Candidates, const FVector& ViewLocation, const FVector& ViewDirection, const FInteractionAssistSettings& Settings)
+{
+	const float MinCos = FMath::Cos(FMath::DegreesToRadians(Settings.MaxAngle));
+
+	int32 BestIndex = INDEX_NONE;
+	float BestScore = -BIG_NUMBER;
+
+	for (int32 i = 0; i < Candidates.Num(); ++i)
+	{
+		const FVector Delta = FVector(Candidates.X[i], Candidates.Y[i], Candidates.Z[i]) - ViewLocation;
+		const float DistSq = Delta.SizeSquared();
+
+		if (DistSq > Candidates.ReachSq[i])
+		{
+			continue;
+		}
+
+		const float Cos = FMath::Min((FVector::DotProduct(Delta, ViewDirection) + Candidates.Radius[i]) * FMath::InvSqrt(FMath::Max(DistSq, KINDA_SMALL_NUMBER)), 1.f);
+
+		if (Cos < MinCos)
+		{
+			continue;
+		}
+
+		const float Score = Cos * Settings.AngleWeight + (1.f - DistSq * Candidates.InvReachSq[i]) * Settings.DistanceWeight + Candidates.Priority[i] * Settings.PriorityWeight;
+
+		if (Score > BestScore)
+		{
+			BestScore = Score;
+			BestIndex = i;
+		}
+	}
+
+	return BestIndex;
+}
+
+//Times the kernel against the scalar version on random candidates around the viewer, and checks they pick the same one
+static void BenchmarkInteractionAssist()
+{
+	const int32 CandidateCounts[] = { 10, 100, 1000 };
+	const int32 NumQueries = 10000;
+
+	FInteractionAssistSettings Settings;
+	Settings.bEnabled = true;
+
+	FInteractionAssistCandidates Candidates;
+	FInteractionAssistCandidates::FFloatArray Scores;
+
+	for (const int32 NumCandidates : CandidateCounts)
+	{
+		FRandomStream Stream(NumCandidates);
+
+		Candidates.Reset();
+		for (int32 i = 0; i < NumCandidates; ++i)
+		{
+			Candidates.Add(Stream.GetUnitVector() * Stream.FRandRange(50.f, 1000.f), Stream.FRandRange(10.f, 50.f), 200.f + Stream.FRandRange(0.f, 800.f), Stream.FRand(), nullptr);
+		}
+		Candidates.Pad();
+
+		//same view directions for both, so they do exactly the same work
+		TArray<FVector> ViewDirections;
+		for (int32 i = 0; i < NumQueries; ++i)
+		{
+			ViewDirections.Add(Stream.GetUnitVector());
+		}
+
+		int32 NumMismatches = 0;
+		int32 Checksum = 0;
+
+		const double KernelStart = FPlatformTime::Seconds();
+		for (const FVector& ViewDirection : ViewDirections)
+		{
+			Checksum += InteractionAssist::FindBestCandidate(Candidates, FVector::ZeroVector, ViewDirection, Settings, Scores);
+		}
+		const double KernelTime = FPlatformTime::Seconds() - KernelStart;
+
+		const double ScalarStart = FPlatformTime::Seconds();
+		for (const FVector& ViewDirection : ViewDirections)
+		{
+			Checksum -= InteractionAssist::FindBestCandidate_Scalar(Candidates, FVector::ZeroVector, ViewDirection, Settings);
+		}
+		const double ScalarTime = FPlatformTime::Seconds() - ScalarStart;
+
+		//the kernel uses an estimated square root, so a near tie can go either way. Worth knowing about if it happens a lot
+		for (const FVector& ViewDirection : ViewDirections)
+		{
+			if (InteractionAssist::FindBestCandidate(Candidates, FVector::ZeroVector, ViewDirection, Settings, Scores) != InteractionAssist::FindBestCandidate_Scalar(Candidates, FVector::ZeroVector, ViewDirection, Settings))
+			{
+				++NumMismatches;
+			}
+		}
+
+		UE_LOG(LogTemp, Log, TEXT("Interaction assist, %d candidates: kernel %.3f us, scalar %.3f us per query (%.2fx), %d/%d picks differ (checksum %d)"),
+			NumCandidates, KernelTime * 1000000.0 / NumQueries, ScalarTime * 1000000.0 / NumQueries, ScalarTime / FMath::Max(KernelTime, SMALL_NUMBER), NumMismatches, NumQueries, Checksum);
+	}
+}
+
+static FAutoConsoleCommand BenchmarkInteractionAssistCommand(
+	TEXT("Survival.BenchmarkInteractionAssist"),
+	TEXT("Times interaction assist scoring at 10, 100 and 1000 candidates, SIMD kernel against scalar"),
+	FConsoleCommandDelegate::CreateStatic(&BenchmarkInteractionAssist));
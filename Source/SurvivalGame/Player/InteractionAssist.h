@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InteractionAssist.generated.h"
+
+//How forgiving the interaction check is for one kind of input device
+USTRUCT(BlueprintType)
+struct FInteractionAssistSettings
+{
+	GENERATED_BODY()
+
+	FInteractionAssistSettings()
+	{
+		bEnabled = false;
+		MaxAngle = 15.f;
+		AngleWeight = 1.f;
+		DistanceWeight = 0.5f;
+		PriorityWeight = 0.25f;
+	}
+
+	//If false we just use the single line trace, which is fine with a mouse
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Interaction Assist")
+	bool bEnabled;
+
+	//How far in degrees from where we're looking an interactable can be and still be picked
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Interaction Assist", meta = (ClampMin = 0.0, ClampMax = 90.0))
+	float MaxAngle;
+
+	//How much being closer to the center of the view counts towards a candidates score
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Interaction Assist")
+	float AngleWeight;
+
+	//How much being closer to the player counts towards a candidates score
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Interaction Assist")
+	float DistanceWeight;
+
+	//How much an interactables AssistPriority counts towards its score
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Interaction Assist")
+	float PriorityWeight;
+};
+
+/**
+ * Everything the interaction assist might pick, laid out as a structure of arrays so the scoring kernel can work on four candidates
+ * at a time. Always padded to a multiple of four with candidates that can never be picked, so the kernel has no scalar tail.
+ */
+struct FInteractionAssistCandidates
+{
+	typedef TArray<float, TAlignedHeapAllocator<16>> FFloatArray;
+
+	FFloatArray X;
+	FFloatArray Y;
+	FFloatArray Z;
+	FFloatArray Radius;
+	FFloatArray ReachSq;
+	FFloatArray InvReachSq;
+	FFloatArray Priority;
+
+	//Not read by the kernel, just tells us what the winning index was
+	TArray<class UInteractionComponent*> Components;
+
+	void Reset();
+	void Add(const FVector& Location, const float InRadius, const float Reach, const float InPriority, class UInteractionComponent* Component);
+
+	//Call once everything has been added, before scoring
+	void Pad();
+
+	FORCEINLINE int32 Num() const { return X.Num(); }
+};
+
+namespace InteractionAssist
+{
+	//Score every candidate on angle, distance and priority, four at a time. Returns the best candidates index, or INDEX_NONE if none are in range and inside the cone
+	int32 FindBestCandidate(const FInteractionAssistCandidates& Candidates, const FVector& ViewLocation, const FVector& ViewDirection, const FInteractionAssistSettings& Settings, FInteractionAssistCandidates::FFloatArray& OutScores);
+
+	//The same scoring one candidate at a time. Only used to check the kernel against and benchmark it
+	int32 FindBestCandidate_Scalar(const FInteractionAssistCandidates& Candidates, const FVector& ViewLocation, const FVector& ViewDirection, const FInteractionAssistSettings& Settings);
+}
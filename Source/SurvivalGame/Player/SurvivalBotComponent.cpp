@@ -0,0 +1,210 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SurvivalBotComponent.h"
+#include "Player/SurvivalCharacter.h"
+#include "Components/InteractionComponent.h"
+#include "Components/InventoryComponent.h"
+#include "Items/Item.h"
+#include "Framework/SurvivalTickAudit.h"
+#include "GameFramework/PlayerController.h"
+#include "InputCoreTypes.h"
+#include "Misc/Parse.h"
+#include "Misc/CommandLine.h"
+
+USurvivalBotComponent::USurvivalBotComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+
+	TurnRate = 60.f;
+	LookDownPitch = -20.f;
+	LootAllInterval = 20.f;
+	UseItemInterval = 10.f;
+	CancelInteractChance = 0.2f;
+	Seed = 0;
+
+	MoveTimeRemaining = 0.f;
+	TurnDirection = 0.f;
+	TurnTimeRemaining = 0.f;
+	bHoldingInteract = false;
+	InteractTimeRemaining = 0.f;
+	LootAllTimeRemaining = 0.f;
+	UseItemTimeRemaining = 0.f;
+}
+
+void USurvivalBotComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	//every bot does something different, but the same bot does the same thing each run. each bot is its own process, so
+	//the load test script hands out the index
+	int32 BotSeed = Seed;
+	int32 BotIndex = 0;
+	FParse::Value(FCommandLine::Get(), TEXT("SurvivalBotSeed="), BotSeed);
+	FParse::Value(FCommandLine::Get(), TEXT("SurvivalBotIndex="), BotIndex);
+
+	Stream.Initialize(HashCombine(GetTypeHash(BotSeed), GetTypeHash(BotIndex)));
+
+	LootAllTimeRemaining = Stream.FRandRange(0.f, LootAllInterval);
+	UseItemTimeRemaining = Stream.FRandRange(0.f, UseItemInterval);
+}
+
+void USurvivalBotComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	//dont leave keys held down on the player controller
+	if (MoveKey.IsValid())
+	{
+		ReleaseKey(MoveKey);
+	}
+
+	if (bHoldingInteract)
+	{
+		ReleaseKey(EKeys::E);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void USurvivalBotComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	SURVIVAL_TICK_AUDIT_SCOPE();
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	//waiting to spawn, or dead
+	if (!GetCharacter())
+	{
+		return;
+	}
+
+	MoveTimeRemaining -= DeltaTime;
+	if (MoveTimeRemaining <= 0.f)
+	{
+		ChooseMovement();
+	}
+
+	UpdateLook(DeltaTime);
+	UpdateInteract(DeltaTime);
+
+	LootAllTimeRemaining -= DeltaTime;
+	if (LootAllTimeRemaining <= 0.f)
+	{
+		TapKey(EKeys::F);
+		LootAllTimeRemaining = LootAllInterval;
+	}
+
+	UseItemTimeRemaining -= DeltaTime;
+	if (UseItemTimeRemaining <= 0.f)
+	{
+		UseRandomItem();
+		UseItemTimeRemaining = UseItemInterval;
+	}
+}
+
+void USurvivalBotComponent::ChooseMovement()
+{
+	static const FKey MoveKeys[] = { EKeys::W, EKeys::W, EKeys::W, EKeys::A, EKeys::S, EKeys::D };
+
+	if (MoveKey.IsValid())
+	{
+		ReleaseKey(MoveKey);
+		MoveKey = FKey();
+	}
+
+	//standing still for a bit is normal too, mostly while looting
+	if (Stream.FRand() > 0.2f)
+	{
+		MoveKey = MoveKeys[Stream.RandHelper(ARRAY_COUNT(MoveKeys))];
+		PressKey(MoveKey);
+	}
+
+	MoveTimeRemaining = Stream.FRandRange(1.f, 4.f);
+}
+
+void USurvivalBotComponent::UpdateLook(const float DeltaTime)
+{
+	APlayerController* PC = GetPlayerController();
+
+	TurnTimeRemaining -= DeltaTime;
+	if (TurnTimeRemaining <= 0.f)
+	{
+		TurnDirection = Stream.FRandRange(-1.f, 1.f);
+		TurnTimeRemaining = Stream.FRandRange(0.5f, 2.f);
+	}
+
+	//ease the pitch back towards looking a little down. LookUp is bound with a scale of -1, so mouse up is pitch up
+	const float Pitch = FRotator::NormalizeAxis(PC->GetControlRotation().Pitch);
+	const float PitchCorrection = FMath::Clamp((LookDownPitch - Pitch) * 0.1f, -1.f, 1.f);
+
+	PC->InputAxis(EKeys::MouseX, TurnDirection * TurnRate * DeltaTime, DeltaTime, 1, false);
+	PC->InputAxis(EKeys::MouseY, PitchCorrection, DeltaTime, 1, false);
+}
+
+void USurvivalBotComponent::UpdateInteract(const float DeltaTime)
+{
+	ASurvivalCharacter* Character = GetCharacter();
+
+	if (bHoldingInteract)
+	{
+		InteractTimeRemaining -= DeltaTime;
+
+		if (InteractTimeRemaining <= 0.f)
+		{
+			ReleaseKey(EKeys::E);
+			bHoldingInteract = false;
+		}
+
+		return;
+	}
+
+	//hold Interact on whatever we're looking at, long enough to finish it most of the time
+	if (UInteractionComponent* Interactable = Character->GetInteractable())
+	{
+		const bool bCancel = Stream.FRand() < CancelInteractChance;
+		InteractTimeRemaining = (Interactable->InteractionTime + 0.2f) * (bCancel ? Stream.FRandRange(0.2f, 0.8f) : 1.f);
+
+		PressKey(EKeys::E);
+		bHoldingInteract = true;
+	}
+}
+
+void USurvivalBotComponent::PressKey(const FKey& Key)
+{
+	GetPlayerController()->InputKey(Key, IE_Pressed, 1.f, false);
+}
+
+void USurvivalBotComponent::ReleaseKey(const FKey& Key)
+{
+	if (APlayerController* PC = GetPlayerController())
+	{
+		PC->InputKey(Key, IE_Released, 0.f, false);
+	}
+}
+
+void USurvivalBotComponent::TapKey(const FKey& Key)
+{
+	PressKey(Key);
+	ReleaseKey(Key);
+}
+
+void USurvivalBotComponent::UseRandomItem()
+{
+	ASurvivalCharacter* Character = GetCharacter();
+	const TArray<UItem*> Items = Character->PlayerInventory->GetItems();
+
+	if (Items.Num() > 0)
+	{
+		Character->UseItem(Items[Stream.RandHelper(Items.Num())]);
+	}
+}
+
+APlayerController* USurvivalBotComponent::GetPlayerController() const
+{
+	return Cast<APlayerController>(GetOwner());
+}
+
+ASurvivalCharacter* USurvivalBotComponent::GetCharacter() const
+{
+	APlayerController* PC = GetPlayerController();
+	return PC ? Cast<ASurvivalCharacter>(PC->GetPawn()) : nullptr;
+}
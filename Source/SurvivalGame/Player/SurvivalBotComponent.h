@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SurvivalBotComponent.generated.h"
+
+/**
+ * Plays the game on a headless client for load testing. Added to the local player controller when the client is started with
+ * -SurvivalBot. Everything goes in as key presses and mouse movement through the player controller, so the bot walks, looks
+ * around, focuses and holds Interact through the same bindings and server RPCs as a real player.
+ * Inventory items are used through UseItem, the same call the inventory UI makes.
+ * What a bot does is random, seeded from Seed and its bot index, so a load test run can be repeated. Both can be set on the command
+ * line with -SurvivalBotSeed=<n> and -SurvivalBotIndex=<n>.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class SURVIVALGAME_API USurvivalBotComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	USurvivalBotComponent();
+
+	//How fast the bot turns, in mouse units per second
+	UPROPERTY(EditDefaultsOnly, Category = "Bot")
+	float TurnRate;
+
+	//The pitch the bot tries to keep, looking a little down so it sees the loot on the ground
+	UPROPERTY(EditDefaultsOnly, Category = "Bot")
+	float LookDownPitch;
+
+	//Seconds between loot alls, and between using a random inventory item
+	UPROPERTY(EditDefaultsOnly, Category = "Bot")
+	float LootAllInterval;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Bot")
+	float UseItemInterval;
+
+	//Chance of letting go of Interact before the interaction finishes, like a player changing their mind
+	UPROPERTY(EditDefaultsOnly, Category = "Bot", meta = (ClampMin = 0.0, ClampMax = 1.0))
+	float CancelInteractChance;
+
+	//The seed every bot in a run shares, combined with each bot's index. -SurvivalBotSeed overrides it
+	UPROPERTY(EditDefaultsOnly, Category = "Bot")
+	int32 Seed;
+
+protected:
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	//Hold a new movement key, or none, for a while
+	void ChooseMovement();
+
+	void UpdateLook(const float DeltaTime);
+	void UpdateInteract(const float DeltaTime);
+
+	//Press or release a key as if it came from the keyboard
+	void PressKey(const FKey& Key);
+	void ReleaseKey(const FKey& Key);
+	void TapKey(const FKey& Key);
+
+	void UseRandomItem();
+
+	class APlayerController* GetPlayerController() const;
+	class ASurvivalCharacter* GetCharacter() const;
+
+	//The movement key being held, if any
+	FKey MoveKey;
+	float MoveTimeRemaining;
+
+	//Which way and how hard the bot is turning right now
+	float TurnDirection;
+	float TurnTimeRemaining;
+
+	//Holding Interact, and until when
+	bool bHoldingInteract;
+	float InteractTimeRemaining;
+
+	float LootAllTimeRemaining;
+	float UseItemTimeRemaining;
+
+	FRandomStream Stream;
+
+};
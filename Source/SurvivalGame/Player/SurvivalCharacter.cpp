@@ -2,16 +2,32 @@
 
 
 #include "SurvivalCharacter.h"
+#include "SurvivalGame.h"
 #include "Camera/CameraComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Components/InteractionComponent.h"
+#include "Components/InventoryComponent.h"
+#include "Components/CraftingComponent.h"
+#include "Components/EquipmentComponent.h"
+#include "Components/StatusEffectComponent.h"
+#include "Components/LoadTestMonitorComponent.h"
+#include "Items/Item.h"
+#include "Net/UnrealNetwork.h"
+#include "Components/GearMeshMergeComponent.h"
+#include "Framework/SurvivalSignificanceManager.h"
+#include "Framework/SurvivalPlayerController.h"
+#include "Framework/SurvivalTickAudit.h"
+#include "World/Pickup.h"
+#include "Engine/World.h"
 
 // Sets default values
-ASurvivalCharacter::ASurvivalCharacter()
+ASurvivalCharacter::ASurvivalCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<USurvivalCharacterMovement>(ACharacter::CharacterMovementComponentName))
 {
- 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	//Tick only runs interaction checks, UpdateInteractionCheckTick turns it on for the characters that need them
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 
 	CameraComponent = CreateDefaultSubobject<UCameraComponent>("CameraComponent");
 	CameraComponent->SetupAttachment(GetMesh(),FName("CameraSocket"));
@@ -45,10 +61,46 @@ ASurvivalCharacter::ASurvivalCharacter()
 	BackpackMesh->SetupAttachment(GetMesh());
 	BackpackMesh->SetMasterPoseComponent(GetMesh());
 
+	PlayerMeshes.Add(EEquippableSlot::EIS_Helmet, HelmetMesh);
+	PlayerMeshes.Add(EEquippableSlot::EIS_Chest, ChestMesh);
+	PlayerMeshes.Add(EEquippableSlot::EIS_Legs, LegsMesh);
+	PlayerMeshes.Add(EEquippableSlot::EIS_Feet, FeetMesh);
+	PlayerMeshes.Add(EEquippableSlot::EIS_Vest, VestMesh);
+	PlayerMeshes.Add(EEquippableSlot::EIS_Hands, HandsMesh);
+	PlayerMeshes.Add(EEquippableSlot::EIS_Backpack, BackpackMesh);
+
+	GearMeshMerge = CreateDefaultSubobject<UGearMeshMergeComponent>("GearMeshMerge");
+
+	PlayerInventory = CreateDefaultSubobject<UInventoryComponent>("PlayerInventory");
+
+	PlayerCrafting = CreateDefaultSubobject<UCraftingComponent>("PlayerCrafting");
+
+	PlayerEquipment = CreateDefaultSubobject<UEquipmentComponent>("PlayerEquipment");
+
 	InteractionCheckFrequency = 0.f;
 	InteractionCheckDistance = 1000.f;
+	LootAllRadius = 250.f;
+
+	GamepadInteractionAssist.bEnabled = true;
+	LastPredictionKey = 0;
+
+	bHasInteractionViewOverride = false;
+	bInteractionViewOverrideGamepad = false;
+	InteractionViewOverrideLocation = FVector::ZeroVector;
+	InteractionViewOverrideRotation = FRotator::ZeroRotator;
+
+	bUseServerAnimationBudget = true;
+	ServerAnimationInterval = 1.f / 15.f;
+	LastServerAnimationTime = 0.f;
+
+	MaxHealth = 100.f;
+	MaxHunger = 100.f;
+	Health = MaxHealth;
+	Hunger = MaxHunger;
+	SpeedMultiplier = 1.f;
 
 	GetCharacterMovement()->NavAgentProps.bCanCrouch = true;
+	BaseWalkSpeed = GetCharacterMovement()->MaxWalkSpeed;
 
 	GetMesh()->SetOwnerNoSee(true);
 
@@ -58,7 +110,191 @@ ASurvivalCharacter::ASurvivalCharacter()
 void ASurvivalCharacter::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	UpdateInteractionCheckTick();
+
+	//let the significance manager throttle our mesh tick rate when we're a remote character. It only exists on clients
+	if (USurvivalSignificanceManager* SignificanceManager = USignificanceManager::Get<USurvivalSignificanceManager>(GetWorld()))
+	{
+		SignificanceManager->RegisterCharacter(this);
+	}
+
+	//a timer with no interval never fires, so with none set the mesh keeps ticking by itself
+	if (GetNetMode() == NM_DedicatedServer && bUseServerAnimationBudget && ServerAnimationInterval > 0.f)
+	{
+		SetupServerAnimation();
+	}
+}
+
+void ASurvivalCharacter::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	//blueprints can change the walk speed, and this runs before any replicated speed multiplier gets applied on top of it
+	BaseWalkSpeed = GetCharacterMovement()->MaxWalkSpeed;
+}
+
+void ASurvivalCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USurvivalSignificanceManager* SignificanceManager = USignificanceManager::Get<USurvivalSignificanceManager>(GetWorld()))
+	{
+		SignificanceManager->UnregisterCharacter(this);
+	}
+
+	if (UStatusEffectComponent* StatusEffects = UStatusEffectComponent::Get(this))
+	{
+		StatusEffects->ClearEffects(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ASurvivalCharacter::SetupServerAnimation()
+{
+	//the body pose is driven by our timer and by RefreshServerAnimation now, so its tick would only double up
+	GetMesh()->SetComponentTickEnabled(false);
+	//nothing is ever rendered on the server, so the body must be allowed to refresh bones without being seen
+	GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+
+	//gear is purely cosmetic, the server never ticks it or copies bones into it
+	for (auto& PlayerMesh : PlayerMeshes)
+	{
+		if (USkeletalMeshComponent* GearComponent = PlayerMesh.Value)
+		{
+			GearComponent->SetComponentTickEnabled(false);
+			GearComponent->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+			GearComponent->bNoSkeletonUpdate = true;
+		}
+	}
+
+	LastServerAnimationTime = GetWorld()->GetTimeSeconds();
+	GetWorldTimerManager().SetTimer(TimerHandle_ServerAnimation, this, &ASurvivalCharacter::UpdateServerAnimation, ServerAnimationInterval, true);
+}
+
+void ASurvivalCharacter::UpdateServerAnimation()
+{
+	const float CurrentTime = GetWorld()->GetTimeSeconds();
+	const float DeltaTime = CurrentTime - LastServerAnimationTime;
+
+	//already evaluated this frame, e.g. a query refreshed us just before the timer fired, or a timer shorter than the frame fired again
+	if (DeltaTime <= 0.f)
+	{
+		return;
+	}
+
+	LastServerAnimationTime = CurrentTime;
+
+	//advance the anim graph by however long it's been since we last did, then evaluate the pose straight away on the game thread
+	GetMesh()->TickAnimation(DeltaTime, false);
+	GetMesh()->RefreshBoneTransforms();
+}
+
+void ASurvivalCharacter::RefreshServerAnimation()
+{
+	if (GetWorldTimerManager().IsTimerActive(TimerHandle_ServerAnimation))
+	{
+		UpdateServerAnimation();
+	}
+}
+
+void ASurvivalCharacter::GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ASurvivalCharacter, Health);
+	DOREPLIFETIME(ASurvivalCharacter, Hunger);
+	DOREPLIFETIME(ASurvivalCharacter, SpeedMultiplier);
+}
+
+void ASurvivalCharacter::UseItem(class UItem* Item)
+{
+	if (!HasAuthority())
+	{
+		ServerUseItem(Item);
+		return;
+	}
+
+	//only use items that are really in our inventory, a client could send anything
+	if (Item && PlayerInventory && Item->OwningInventory == PlayerInventory)
+	{
+		Item->Use(this);
+	}
+}
+
+void ASurvivalCharacter::ServerUseItem_Implementation(class UItem* Item)
+{
+	ULoadTestMonitorComponent::RecordServerRPC(this);
+	UseItem(Item);
+}
+
+void ASurvivalCharacter::ServerMovePacked_Implementation(const FSurvivalMoveBatch& Batch)
+{
+	if (USurvivalCharacterMovement* Movement = Cast<USurvivalCharacterMovement>(GetCharacterMovement()))
+	{
+		Movement->ServerMovePacked_Implementation(Batch);
+	}
+}
+
+bool ASurvivalCharacter::ServerMovePacked_Validate(const FSurvivalMoveBatch& Batch)
+{
+	return true;
+}
+
+bool ASurvivalCharacter::ServerUseItem_Validate(class UItem* Item)
+{
+	return true;
+}
+
+void ASurvivalCharacter::ApplyStatusEffects(const float HealthDelta, const float HungerDelta, const float NewSpeedMultiplier)
+{
+	//only assign what actually changed, so a character at full health with a heal running doesn't replicate anything
+	const float NewHealth = FMath::Clamp(Health + HealthDelta, 0.f, MaxHealth);
+	if (NewHealth != Health)
+	{
+		Health = NewHealth;
+	}
+
+	const float NewHunger = FMath::Clamp(Hunger + HungerDelta, 0.f, MaxHunger);
+	if (NewHunger != Hunger)
+	{
+		Hunger = NewHunger;
+	}
+
+	if (NewSpeedMultiplier != SpeedMultiplier)
+	{
+		SpeedMultiplier = NewSpeedMultiplier;
+
+		//server doesnt get rep notifies, so call it ourselves
+		OnRep_SpeedMultiplier();
+	}
+}
+
+void ASurvivalCharacter::OnRep_SpeedMultiplier()
+{
+	GetCharacterMovement()->MaxWalkSpeed = BaseWalkSpeed * SpeedMultiplier;
+}
+
+void ASurvivalCharacter::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+
+	GearMeshMerge->RefreshGearMeshes();
+	UpdateInteractionCheckTick();
+}
+
+void ASurvivalCharacter::UnPossessed()
+{
+	Super::UnPossessed();
+
+	UpdateInteractionCheckTick();
+}
+
+void ASurvivalCharacter::PawnClientRestart()
+{
+	Super::PawnClientRestart();
+
+	GearMeshMerge->RefreshGearMeshes();
+	UpdateInteractionCheckTick();
 }
 
 bool ASurvivalCharacter::IsInteracting() const
@@ -118,31 +354,77 @@ void ASurvivalCharacter::Turn(float Val)
 // Called every frame
 void ASurvivalCharacter::Tick(float DeltaTime)
 {
+	SURVIVAL_TICK_AUDIT_SCOPE();
+
 	Super::Tick(DeltaTime);
 
-	//const bool bIsInteractingOnServer = (GetNetMode() == NM_DedicatedServer && IsInteracting());
+	//the tick interval is the check frequency, so every tick is a check
+	PerformInteractionCheck();
+}
 
-	//if not server or if interacting on server AND the time since last interaction check is greater than the established interaction check frequency 
-	if (GetWorld()->TimeSince(InteractionData.LastInteractionCheckTime) > InteractionCheckFrequency)
-	{
-		PerformInteractionCheck();
-	}
+void ASurvivalCharacter::UpdateInteractionCheckTick()
+{
+	//a replay decides when to check instead
+	const bool bNeedsInteractionCheck = !bHasInteractionViewOverride && GetController() && (IsLocallyControlled() || IsInteracting());
+
+	SetActorTickInterval(InteractionCheckFrequency);
+	SetActorTickEnabled(bNeedsInteractionCheck);
 }
 
 void ASurvivalCharacter::PerformInteractionCheck()
 {
+	SURVIVAL_SCOPE_CYCLE_COUNTER(InteractionCheck);
 
 	if (GetController() == nullptr)
 	{
 		return;
 	}
 
+	SURVIVAL_INC_COUNTER(InteractionChecks, 1);
+
 	InteractionData.LastInteractionCheckTime = GetWorld()->GetTimeSeconds();
 
 	FVector EyesLoc;
 	FRotator EyesRot;
+	bool bUsingGamepad = false;
+
+	if (bHasInteractionViewOverride)
+	{
+		EyesLoc = InteractionViewOverrideLocation;
+		EyesRot = InteractionViewOverrideRotation;
+		bUsingGamepad = bInteractionViewOverrideGamepad;
+	}
+	else
+	{
+		//the view comes from the camera on the mesh socket, which is as old as the last pose the server evaluated
+		RefreshServerAnimation();
+		GetController()->GetPlayerViewPoint(EyesLoc, EyesRot);
 
-	GetController()->GetPlayerViewPoint(EyesLoc, EyesRot);
+		const ASurvivalPlayerController* PC = Cast<ASurvivalPlayerController>(GetController());
+		bUsingGamepad = PC && PC->IsUsingGamepad();
+	}
+
+	OnInteractionCheck.Broadcast(EyesLoc, EyesRot, bUsingGamepad);
+
+	//a gamepad can't aim as precisely as a mouse, so pick the best candidate near the crosshair instead of needing a direct hit
+	const FInteractionAssistSettings& AssistSettings = bUsingGamepad ? GamepadInteractionAssist : MouseInteractionAssist;
+
+	if (AssistSettings.bEnabled)
+	{
+		if (UInteractionComponent* InteractionComponent = FindAssistedInteractable(EyesLoc, EyesRot.Vector(), AssistSettings))
+		{
+			if (InteractionComponent != GetInteractable())
+			{
+				FoundNewInteractable(InteractionComponent);
+			}
+		}
+		else
+		{
+			CouldntFindInteractable();
+		}
+
+		return;
+	}
 
 	FVector TraceStart = EyesLoc;
 	FVector TraceEnd = (EyesRot.Vector() * InteractionCheckDistance) + TraceStart;
@@ -177,6 +459,75 @@ void ASurvivalCharacter::PerformInteractionCheck()
 
 }
 
+UInteractionComponent* ASurvivalCharacter::FindAssistedInteractable(const FVector& ViewLocation, const FVector& ViewDirection, const FInteractionAssistSettings& AssistSettings)
+{
+	const UWorld* World = GetWorld();
+	const float MaxDistanceSq = FMath::Square(InteractionCheckDistance);
+
+	AssistCandidates.Reset();
+
+	//only gather what's in reach, the physics scene can find that without us going through every interactable in the world.
+	//Visibility is what the interaction trace hits, so anything we could focus normally shows up here
+	AssistOverlaps.Reset();
+	FCollisionQueryParams OverlapParams(SCENE_QUERY_STAT(InteractionAssistGather), false, this);
+	World->OverlapMultiByChannel(AssistOverlaps, ViewLocation, FQuat::Identity, ECC_Visibility, FCollisionShape::MakeSphere(InteractionCheckDistance), OverlapParams);
+
+	for (const FOverlapResult& Overlap : AssistOverlaps)
+	{
+		AActor* InteractableOwner = Overlap.GetActor();
+
+		//hidden covers pickups we've predicted taking
+		if (!InteractableOwner || InteractableOwner == this || InteractableOwner->bHidden)
+		{
+			continue;
+		}
+
+		TInlineComponentArray<UInteractionComponent*> Interactables(InteractableOwner);
+
+		for (UInteractionComponent* Interactable : Interactables)
+		{
+			//an actor with more than one colliding component overlaps once for each
+			if (!Interactable->IsActive() || AssistCandidates.Components.Contains(Interactable))
+			{
+				continue;
+			}
+
+			//aim at the middle of whatever the component is attached to, and let its size help us hit it
+			const USceneComponent* Parent = Interactable->GetAttachParent();
+			const FVector Location = Parent ? Parent->Bounds.Origin : Interactable->GetComponentLocation();
+			const float Radius = Parent ? Parent->Bounds.SphereRadius : 0.f;
+
+			if (FVector::DistSquared(ViewLocation, Location) <= MaxDistanceSq)
+			{
+				AssistCandidates.Add(Location, Radius, Interactable->InteractionDistance + Radius, Interactable->AssistPriority, Interactable);
+			}
+		}
+	}
+
+	AssistCandidates.Pad();
+
+	const int32 BestIndex = InteractionAssist::FindBestCandidate(AssistCandidates, ViewLocation, ViewDirection, AssistSettings, AssistScores);
+
+	if (BestIndex == INDEX_NONE)
+	{
+		return nullptr;
+	}
+
+	//only the winner gets a trace, to make sure it isn't behind a wall
+	UInteractionComponent* Best = AssistCandidates.Components[BestIndex];
+	const FVector Target(AssistCandidates.X[BestIndex], AssistCandidates.Y[BestIndex], AssistCandidates.Z[BestIndex]);
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(InteractionAssist), false, this);
+	FHitResult TraceHit;
+
+	if (GetWorld()->LineTraceSingleByChannel(TraceHit, ViewLocation, Target, ECC_Visibility, QueryParams) && TraceHit.GetActor() != Best->GetOwner())
+	{
+		return nullptr;
+	}
+
+	return Best;
+}
+
 void ASurvivalCharacter::CouldntFindInteractable()
 {
 	//if we were looking at an interactable and now cant find one, we must have stopped looking at that interactable
@@ -190,6 +541,7 @@ void ASurvivalCharacter::CouldntFindInteractable()
 	if (UInteractionComponent* Interactable = GetInteractable())
 	{
 		Interactable->EndFocus(this);
+		OnInteractionEvent.Broadcast(EInteractionEvent::EndFocus, Interactable);
 
 		if (InteractionData.bInteractHeld)
 		{
@@ -208,10 +560,12 @@ void ASurvivalCharacter::FoundNewInteractable(UInteractionComponent* Interactabl
 	if (UInteractionComponent* OldInteractable = GetInteractable())
 	{
 		OldInteractable->EndFocus(this);
+		OnInteractionEvent.Broadcast(EInteractionEvent::EndFocus, OldInteractable);
 	}
 	//now we focus on the new interaction component 
 	InteractionData.ViewedInteractionComponent = Interactable;
 	Interactable->BeginFocus(this);
+	OnInteractionEvent.Broadcast(EInteractionEvent::BeginFocus, Interactable);
 }
 
 void ASurvivalCharacter::BeginInteract()
@@ -219,7 +573,9 @@ void ASurvivalCharacter::BeginInteract()
 	//if you have authority then you are the server 
 	if (!HasAuthority())
 	{
-		ServerBeginInteract();
+		//the server is told which key this interaction uses, so it can ack whatever we predict for it
+		InteractionData.PredictionKey = ++LastPredictionKey;
+		ServerBeginInteract(InteractionData.PredictionKey);
 	}
 
 	//interact key is being held
@@ -230,6 +586,7 @@ void ASurvivalCharacter::BeginInteract()
 	if (UInteractionComponent* Interactable = GetInteractable())
 	{
 		Interactable->BeginInteract(this);
+		OnInteractionEvent.Broadcast(EInteractionEvent::BeginInteract, Interactable);
 
 		//if interact time is basically zero, interact straight away
 		if (FMath::IsNearlyZero(Interactable->InteractionTime))
@@ -243,11 +600,15 @@ void ASurvivalCharacter::BeginInteract()
 			GetWorldTimerManager().SetTimer(TimerHandle_Interact, this, &ASurvivalCharacter::Interact, Interactable->InteractionTime, false);
 		}
 	}
+
+	UpdateInteractionCheckTick();
 }
 
 void ASurvivalCharacter::EndInteract()
 {
-	if (!HasAuthority())
+	//once an interaction has completed there's nothing left for the server to cancel. Telling it anyway could race its own timer,
+	//which is a frame or so behind ours, and undo a pickup it was about to give us
+	if (!HasAuthority() && InteractionData.bInteractHeld)
 	{
 		ServerEndInteract();
 	}
@@ -255,6 +616,12 @@ void ASurvivalCharacter::EndInteract()
 	//interaction key let go (need to end interaction if it was let go before interaction time length 
 	InteractionData.bInteractHeld = false; 
 
+	//if the interaction never completed, the client needs to undo anything it predicted. Does nothing if it was already acked
+	if (HasAuthority() && PlayerInventory && InteractionData.PredictionKey > 0)
+	{
+		PlayerInventory->AckPrediction(InteractionData.PredictionKey, false);
+	}
+
 	//clear timer
 	GetWorldTimerManager().ClearTimer(TimerHandle_Interact);
 
@@ -262,8 +629,10 @@ void ASurvivalCharacter::EndInteract()
 	if (UInteractionComponent* Interactable = GetInteractable())
 	{
 		Interactable->EndInteract(this);
+		OnInteractionEvent.Broadcast(EInteractionEvent::EndInteract, Interactable);
 	}
 
+	UpdateInteractionCheckTick();
 }
 
 void ASurvivalCharacter::Interact()
@@ -271,15 +640,151 @@ void ASurvivalCharacter::Interact()
 	//if we had a duration based interaction cue, clear it as we are about to do the interaction 	
 	GetWorldTimerManager().ClearTimer(TimerHandle_Interact);
 
+	//the interaction is done, so letting go of the key or losing focus on the predicted pickup doesn't end it
+	InteractionData.bInteractHeld = false;
+
 	//take interactable and call the interact function on the interactable
 	if (UInteractionComponent* Interactable = GetInteractable())
 	{
 		Interactable->Interact(this);
+		OnInteractionEvent.Broadcast(EInteractionEvent::Interact, Interactable);
 	}
+
+	UpdateInteractionCheckTick();
+}
+
+void ASurvivalCharacter::SetInteractionViewOverride(const FVector& ViewLocation, const FRotator& ViewRotation, const bool bUsingGamepad)
+{
+	bHasInteractionViewOverride = true;
+	bInteractionViewOverrideGamepad = bUsingGamepad;
+	InteractionViewOverrideLocation = ViewLocation;
+	InteractionViewOverrideRotation = ViewRotation;
+
+	UpdateInteractionCheckTick();
+}
+
+void ASurvivalCharacter::LootAll()
+{
+	if (!HasAuthority())
+	{
+		ServerLootAll();
+		return;
+	}
+
+	if (!PlayerInventory)
+	{
+		return;
+	}
+
+	//one overlap finds the whole pile, rather than the player having to look at and interact with every item in it
+	TArray<FOverlapResult> Overlaps;
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(LootAll), false, this);
+	GetWorld()->OverlapMultiByChannel(Overlaps, GetActorLocation(), FQuat::Identity, ECC_Visibility, FCollisionShape::MakeSphere(LootAllRadius), QueryParams);
+
+	const FVector ViewLocation = GetPawnViewLocation();
+	TArray<APickup*, TInlineAllocator<64>> Pickups;
+	TArray<FVector, TInlineAllocator<64>> PickupTargets;
+
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		APickup* Pickup = Cast<APickup>(Overlap.GetActor());
+
+		if (!Pickup || Pickup->IsPendingKill() || !Pickup->GetItem() || !Pickup->InteractionComponent || Pickups.Contains(Pickup))
+		{
+			continue;
+		}
+
+		//same reach rule as the interaction assist: the pickups own interaction distance, to the middle of what it's attached to
+		const UInteractionComponent* Interactable = Pickup->InteractionComponent;
+		const USceneComponent* Parent = Interactable->GetAttachParent();
+		const FVector Target = Parent ? Parent->Bounds.Origin : Interactable->GetComponentLocation();
+		const float Reach = Interactable->InteractionDistance + (Parent ? Parent->Bounds.SphereRadius : 0.f);
+
+		if (FVector::DistSquared(ViewLocation, Target) <= FMath::Square(Reach))
+		{
+			Pickups.Add(Pickup);
+			PickupTargets.Add(Target);
+		}
+	}
+
+	//and it has to be in sight, so nobody loots through walls or floors. The rest of the pile doesn't count as being in the way
+	FCollisionQueryParams SightParams(SCENE_QUERY_STAT(LootAllSight), false, this);
+	for (APickup* Pickup : Pickups)
+	{
+		SightParams.AddIgnoredActor(Pickup);
+	}
+
+	for (int32 i = Pickups.Num() - 1; i >= 0; --i)
+	{
+		if (GetWorld()->LineTraceTestByChannel(ViewLocation, PickupTargets[i], ECC_Visibility, SightParams))
+		{
+			Pickups.RemoveAtSwap(i, 1, false);
+			PickupTargets.RemoveAtSwap(i, 1, false);
+		}
+	}
+
+	//if it doesnt all fit, the closest items are the ones we take
+	const FVector Location = GetActorLocation();
+	Pickups.Sort([&Location](const APickup& A, const APickup& B)
+	{
+		return FVector::DistSquared(Location, A.GetActorLocation()) < FVector::DistSquared(Location, B.GetActorLocation());
+	});
+
+	//everything is added in this one call, so the inventory replicates the whole pile in a single update
+	FItemAddResult Result;
+
+	for (APickup* Pickup : Pickups)
+	{
+		const FItemAddResult PickupResult = Pickup->TakePickup(PlayerInventory);
+
+		Result.AmountToGive += FMath::Max(PickupResult.AmountToGive, 0);
+		Result.ActualAmountGiven += PickupResult.ActualAmountGiven;
+
+		//only show the first thing that went wrong
+		if (Result.ErrorText.IsEmpty())
+		{
+			Result.ErrorText = PickupResult.ErrorText;
+		}
+	}
+
+	if (Result.ActualAmountGiven <= 0)
+	{
+		Result.Result = EItemAddResult::IAR_NoItemsAdded;
+	}
+	else if (Result.ActualAmountGiven < Result.AmountToGive)
+	{
+		Result.Result = EItemAddResult::IAR_SomeItemsAdded;
+	}
+	else
+	{
+		Result.Result = EItemAddResult::IAR_AllItemsAdded;
+	}
+
+	ClientLootAllResult(Result);
+}
+
+void ASurvivalCharacter::ServerLootAll_Implementation()
+{
+	ULoadTestMonitorComponent::RecordServerRPC(this);
+	LootAll();
+}
+
+bool ASurvivalCharacter::ServerLootAll_Validate()
+{
+	return true;
+}
+
+void ASurvivalCharacter::ClientLootAllResult_Implementation(const FItemAddResult& Result)
+{
+	OnLootAllResult(Result);
 }
 
 void ASurvivalCharacter::ServerEndInteract_Implementation()
 {
+	SURVIVAL_SCOPE_CYCLE_COUNTER(InteractionRPC);
+	SURVIVAL_INC_COUNTER(InteractionRPCs, 1);
+	ULoadTestMonitorComponent::RecordServerRPC(this);
+
 	EndInteract();
 }
 
@@ -288,12 +793,21 @@ bool ASurvivalCharacter::ServerEndInteract_Validate()
 	return true;
 }
 
-void ASurvivalCharacter::ServerBeginInteract_Implementation()
+void ASurvivalCharacter::ServerBeginInteract_Implementation(const int32 PredictionKey)
 {
+	SURVIVAL_SCOPE_CYCLE_COUNTER(InteractionRPC);
+	SURVIVAL_INC_COUNTER(InteractionRPCs, 1);
+	ULoadTestMonitorComponent::RecordServerRPC(this);
+
+	//we don't check a remote players view while they aren't interacting, so find out what they're looking at now.
+	//Before taking the new key, changing focus ends whatever they were doing before
+	PerformInteractionCheck();
+
+	InteractionData.PredictionKey = PredictionKey;
 	BeginInteract();
 }
 
-bool ASurvivalCharacter::ServerBeginInteract_Validate()
+bool ASurvivalCharacter::ServerBeginInteract_Validate(const int32 PredictionKey)
 {
 	return true; 
 }
@@ -308,6 +822,7 @@ void ASurvivalCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputC
 
 	PlayerInputComponent->BindAction("Interact", IE_Pressed, this, &ASurvivalCharacter::BeginInteract);
 	PlayerInputComponent->BindAction("Interact", IE_Released, this, &ASurvivalCharacter::EndInteract);
+	PlayerInputComponent->BindAction("LootAll", IE_Pressed, this, &ASurvivalCharacter::LootAll);
 
 	PlayerInputComponent->BindAction("Crouch", IE_Pressed, this, &ASurvivalCharacter::StartCrouching);
 	PlayerInputComponent->BindAction("Crouch", IE_Released, this, &ASurvivalCharacter::StopCrouching);
@@ -4,8 +4,38 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "WorldCollision.h"
+#include "Player/InteractionAssist.h"
+#include "Player/SurvivalCharacterMovement.h"
 #include "SurvivalCharacter.generated.h"
 
+//The modular gear slots a character can wear a mesh in
+UENUM(BlueprintType)
+enum class EEquippableSlot : uint8
+{
+	EIS_Helmet UMETA(DisplayName = "Helmet"),
+	EIS_Chest UMETA(DisplayName = "Chest"),
+	EIS_Legs UMETA(DisplayName = "Legs"),
+	EIS_Feet UMETA(DisplayName = "Feet"),
+	EIS_Vest UMETA(DisplayName = "Vest"),
+	EIS_Hands UMETA(DisplayName = "Hands"),
+	EIS_Backpack UMETA(DisplayName = "Backpack")
+};
+
+//What happened to an interactable during an interaction. Used to record interaction sessions and check replays of them
+enum class EInteractionEvent : uint8
+{
+	BeginFocus,
+	EndFocus,
+	BeginInteract,
+	EndInteract,
+	Interact
+};
+
+//Native rather than dynamic, these go off on every check and are only listened to while recording
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnInteractionCheck, const FVector& /*ViewLocation*/, const FRotator& /*ViewRotation*/, const bool /*bUsingGamepad*/);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnInteractionEvent, const EInteractionEvent /*Event*/, class UInteractionComponent* /*Interactable*/);
+
 USTRUCT()
 struct FInteractionData
 {
@@ -16,6 +46,7 @@ struct FInteractionData
 		ViewedInteractionComponent = nullptr;
 		LastInteractionCheckTime = 0.f;
 		bInteractHeld = false;
+		PredictionKey = 0;
 	}
 
 	//The current interactable component we're viewing, if there is one
@@ -29,6 +60,10 @@ struct FInteractionData
 	//Whether the local player is holding the interact key
 	UPROPERTY()
 	bool bInteractHeld;
+
+	//Identifies this interaction, so anything the client predicts about it can be matched up with what the server did
+	UPROPERTY()
+	int32 PredictionKey;
 	
 };
 
@@ -37,9 +72,12 @@ class SURVIVALGAME_API ASurvivalCharacter : public ACharacter
 {
 	GENERATED_BODY()
 
+	//Replays drive the interaction check and the interact key themselves
+	friend class USurvivalInteractionReplay;
+
 public:
 	// Sets default values for this character's properties
-	ASurvivalCharacter();
+	ASurvivalCharacter(const FObjectInitializer& ObjectInitializer);
 
 	UPROPERTY(EditAnywhere, Category = "Components")
 	class UCameraComponent* CameraComponent;
@@ -58,10 +96,35 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Components")
 	class USkeletalMeshComponent* BackpackMesh;
 
+	UPROPERTY(EditAnywhere, Category = "Components")
+	class UInventoryComponent* PlayerInventory;
+
+	UPROPERTY(EditAnywhere, Category = "Components")
+	class UCraftingComponent* PlayerCrafting;
+
+	//Which gear is equipped in each slot, and loads the gear meshes for it
+	UPROPERTY(EditAnywhere, Category = "Components")
+	class UEquipmentComponent* PlayerEquipment;
+
+	//Bakes the equipped gear into a single mesh on remote characters
+	UPROPERTY(EditAnywhere, Category = "Components")
+	class UGearMeshMergeComponent* GearMeshMerge;
+
+	//The gear mesh component for each slot
+	UPROPERTY(BlueprintReadOnly, Category = "Mesh")
+	TMap<EEquippableSlot, USkeletalMeshComponent*> PlayerMeshes;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
-	// Called every frame
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void PostInitializeComponents() override;
+
+	//Whether we're locally controlled can change here, which decides if our gear is merged and if we check for interactables
+	virtual void PossessedBy(AController* NewController) override;
+	virtual void UnPossessed() override;
+	virtual void PawnClientRestart() override;
+	//Only registered while UpdateInteractionCheckTick says there's checking to do, at InteractionCheckFrequency
 	virtual void Tick(float DeltaTime) override;
 
 	//How often in seconds to check for an interactable object. Set this to zero if you want to check every tick.
@@ -72,8 +135,27 @@ protected:
 	UPROPERTY(EditDefaultsOnly, Category = "Interaction")
 	float InteractionCheckDistance;
 
+	//Interaction assist for each input device. Assist picks the best interactable near where we're looking instead of needing an exact hit
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction")
+	FInteractionAssistSettings MouseInteractionAssist;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction")
+	FInteractionAssistSettings GamepadInteractionAssist;
+
 	void PerformInteractionCheck();
 
+	//Locally controlled characters check constantly so what they look at gets highlighted. The server only checks a remote
+	//players view while they're interacting, to stop if they look away. Nobody else checks, so nobody else ticks
+	void UpdateInteractionCheckTick();
+
+	//Score every interactable near us and return the best one, if nothing is blocking our view of it
+	class UInteractionComponent* FindAssistedInteractable(const FVector& ViewLocation, const FVector& ViewDirection, const FInteractionAssistSettings& AssistSettings);
+
+	//Reused every check so we aren't allocating
+	TArray<FOverlapResult> AssistOverlaps;
+	FInteractionAssistCandidates AssistCandidates;
+	FInteractionAssistCandidates::FFloatArray AssistScores;
+
 	void CouldntFindInteractable();
 	void FoundNewInteractable(UInteractionComponent* Interactable);
 
@@ -81,28 +163,65 @@ protected:
 	void EndInteract();
 
 	UFUNCTION(Server, Reliable, WithValidation)
-		void ServerBeginInteract();
+		void ServerBeginInteract(const int32 PredictionKey);
 
 	UFUNCTION(Server, Reliable, WithValidation)
 		void ServerEndInteract();
 
 	void Interact();
 
+	//How far around the player loot all reaches
+	UPROPERTY(EditDefaultsOnly, Category = "Interaction", meta = (ClampMin = 0.0))
+	float LootAllRadius;
+
+	//Take every pickup within LootAllRadius in one go, instead of interacting with them one at a time
+	void LootAll();
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerLootAll();
+
+	//Sends the combined result of a loot all back to the player, so the UI can show one message for the whole pile
+	UFUNCTION(Client, Reliable)
+	void ClientLootAllResult(const struct FItemAddResult& Result);
+
+	//Show the result of a loot all. Done in blueprint
+	UFUNCTION(BlueprintImplementableEvent)
+	void OnLootAllResult(const struct FItemAddResult& Result);
+
 	//information about the current state of the players interaction
 	UPROPERTY()
 	FInteractionData InteractionData;
 
-	//Helper function to make grabbing interactable easier
-	FORCEINLINE class UInteractionComponent* GetInteractable() const { return InteractionData.ViewedInteractionComponent;  }
-
 	FTimerHandle TimerHandle_Interact;
 
+	//[Client] The last prediction key we handed out. Each interaction gets the next one
+	int32 LastPredictionKey;
+
+	bool bHasInteractionViewOverride;
+	bool bInteractionViewOverrideGamepad;
+	FVector InteractionViewOverrideLocation;
+	FRotator InteractionViewOverrideRotation;
+
 public:
+
+	//The prediction key of the current interaction, or zero if it isn't being predicted
+	FORCEINLINE int32 GetInteractionPredictionKey() const { return InteractionData.PredictionKey; }
+
+	//Helper function to make grabbing interactable easier
+	FORCEINLINE class UInteractionComponent* GetInteractable() const { return InteractionData.ViewedInteractionComponent;  }
+
 	//true if we're interacting with an item that has an interaction time
 	bool IsInteracting() const;
 	//Get the time till we interact with the current interactable
 	float GetRemainingInteractTime() const; 
 
+	//Called with the view each interaction check uses, and for every focus and interact event
+	FOnInteractionCheck OnInteractionCheck;
+	FOnInteractionEvent OnInteractionEvent;
+
+	//Check for interactables from this view instead of the controllers, and stop checking by ourselves in Tick. For replays
+	void SetInteractionViewOverride(const FVector& ViewLocation, const FRotator& ViewRotation, const bool bUsingGamepad);
+
 protected:
 
 	void StartCrouching();
@@ -114,6 +233,76 @@ protected:
 	void LookUp(float Val);
 	void Turn(float Val);
 
+	//Whether the dedicated server should only animate the body mesh, at ServerAnimationInterval, instead of every mesh every frame
+	UPROPERTY(EditDefaultsOnly, Category = "Server Animation")
+	bool bUseServerAnimationBudget;
+
+	//How often in seconds the dedicated server updates the body pose. Anything reading bones in between calls RefreshServerAnimation first
+	UPROPERTY(EditDefaultsOnly, Category = "Server Animation", meta = (ClampMin = 0.01, EditCondition = bUseServerAnimationBudget))
+	float ServerAnimationInterval;
+
+	//Stop the meshes ticking by themselves on the server, and update the body pose on a timer instead
+	void SetupServerAnimation();
+
+	void UpdateServerAnimation();
+
+	FTimerHandle TimerHandle_ServerAnimation;
+
+	//The world time the server last updated the body pose
+	float LastServerAnimationTime;
+
+public:
+
+	//[server] Bring the body pose up to date before reading bone or socket transforms, e.g. the camera for an interaction
+	//check. Does nothing if the pose was already evaluated this frame, or the server isn't budgeting animation
+	void RefreshServerAnimation();
+
+	//Use an item in our inventory, e.g. eat it or put it on. Can be called on the client
+	UFUNCTION(BlueprintCallable, Category = "Items")
+	void UseItem(class UItem* Item);
+
+	//[server] Called by the status effect manager with everything our effects added up to since its last pass
+	void ApplyStatusEffects(const float HealthDelta, const float HungerDelta, const float NewSpeedMultiplier);
+
+	UFUNCTION(BlueprintPure, Category = "Stats")
+	FORCEINLINE float GetHealth() const { return Health; }
+
+	UFUNCTION(BlueprintPure, Category = "Stats")
+	FORCEINLINE float GetHunger() const { return Hunger; }
+
+	//A batch of our moves, sent by USurvivalCharacterMovement instead of the engines ServerMove RPCs. Unreliable like those
+	UFUNCTION(Server, Unreliable, WithValidation)
+	void ServerMovePacked(const FSurvivalMoveBatch& Batch);
+
+protected:
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerUseItem(class UItem* Item);
+
+	UPROPERTY(EditDefaultsOnly, Category = "Stats", meta = (ClampMin = 0.0))
+	float MaxHealth;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Stats", meta = (ClampMin = 0.0))
+	float MaxHunger;
+
+	UPROPERTY(Replicated, BlueprintReadOnly, Category = "Stats")
+	float Health;
+
+	UPROPERTY(Replicated, BlueprintReadOnly, Category = "Stats")
+	float Hunger;
+
+	//What status effects are doing to our walk speed. Replicated so the owning client predicts movement at the same speed
+	UPROPERTY(ReplicatedUsing = OnRep_SpeedMultiplier, BlueprintReadOnly, Category = "Stats")
+	float SpeedMultiplier;
+
+	UFUNCTION()
+	void OnRep_SpeedMultiplier();
+
+	//Walk speed before any status effects
+	float BaseWalkSpeed;
+
+	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
+
 public:	
 
 	// Called to bind functionality to input
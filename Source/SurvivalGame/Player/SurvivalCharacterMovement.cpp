@@ -0,0 +1,373 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SurvivalCharacterMovement.h"
+#include "SurvivalGame.h"
+#include "Player/SurvivalCharacter.h"
+#include "Components/LoadTestMonitorComponent.h"
+#include "Framework/SurvivalTickAudit.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarPackedMoves(
+	TEXT("Survival.PackedMoves"),
+	1,
+	TEXT("1 sends our moves to the server in packed batches, 0 uses the engines ServerMove RPCs. Only matters on clients"));
+
+//the view is sent with this many bits of yaw and pitch, from the engines 16
+static const int32 ViewYawBits = 12;
+static const int32 ViewPitchBits = 10;
+
+//what ServerMove gets instead of a client location for a move it shouldn't check, the same as the engines ServerMoveDual uses
+static const FVector NoClientLoc(1.f, 2.f, 3.f);
+
+static void SerializePackedMove(FArchive& Ar, FSurvivalPackedMove& Move, const uint8 PreviousFlags)
+{
+	Ar << Move.TimeStamp;
+
+	//standing still is most moves
+	uint8 bHasAcceleration = Move.Acceleration[0] != 0 || Move.Acceleration[1] != 0 || Move.Acceleration[2] != 0;
+	Ar.SerializeBits(&bHasAcceleration, 1);
+
+	if (bHasAcceleration)
+	{
+		Ar.Serialize(Move.Acceleration, sizeof(Move.Acceleration));
+	}
+	else if (Ar.IsLoading())
+	{
+		FMemory::Memzero(Move.Acceleration);
+	}
+
+	uint8 bSameFlags = Move.Flags == PreviousFlags;
+	Ar.SerializeBits(&bSameFlags, 1);
+
+	if (bSameFlags)
+	{
+		Move.Flags = PreviousFlags;
+	}
+	else
+	{
+		Ar << Move.Flags;
+	}
+}
+
+bool FSurvivalMoveBatch::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	uint32 NumMoves = Moves.Num();
+	Ar.SerializeBits(&NumMoves, 4);
+
+	if (Ar.IsLoading())
+	{
+		if (NumMoves == 0 || NumMoves > (uint32)MaxPackedMoves)
+		{
+			Ar.SetError();
+			bOutSuccess = false;
+			return true;
+		}
+
+		Moves.SetNum(NumMoves);
+	}
+
+	uint8 bOldMove = bHasOldMove;
+	Ar.SerializeBits(&bOldMove, 1);
+	bHasOldMove = bOldMove != 0;
+
+	if (bHasOldMove)
+	{
+		SerializePackedMove(Ar, OldMove, 0);
+	}
+
+	uint8 PreviousFlags = 0;
+	for (FSurvivalPackedMove& Move : Moves)
+	{
+		SerializePackedMove(Ar, Move, PreviousFlags);
+		PreviousFlags = Move.Flags;
+	}
+
+	ClientLoc.NetSerialize(Ar, Map, bOutSuccess);
+	Ar << ClientRoll;
+
+	//View is yaw and pitch as 16 bits each, we only send the top bits of each
+	uint32 Yaw = (((View >> 16) + (1 << (15 - ViewYawBits))) >> (16 - ViewYawBits)) & ((1 << ViewYawBits) - 1);
+	uint32 Pitch = (((View & 0xFFFF) + (1 << (15 - ViewPitchBits))) >> (16 - ViewPitchBits)) & ((1 << ViewPitchBits) - 1);
+	Ar.SerializeBits(&Yaw, ViewYawBits);
+	Ar.SerializeBits(&Pitch, ViewPitchBits);
+	View = (Yaw << (32 - ViewYawBits)) | (Pitch << (16 - ViewPitchBits));
+
+	UObject* Base = ClientMovementBase;
+	bOutSuccess &= Map ? Map->SerializeObject(Ar, UPrimitiveComponent::StaticClass(), Base) : true;
+	ClientMovementBase = Cast<UPrimitiveComponent>(Base);
+
+	uint8 bHasBone = ClientBaseBoneName != NAME_None;
+	Ar.SerializeBits(&bHasBone, 1);
+
+	if (bHasBone)
+	{
+		Ar << ClientBaseBoneName;
+	}
+	else if (Ar.IsLoading())
+	{
+		ClientBaseBoneName = NAME_None;
+	}
+
+	Ar << ClientMovementMode;
+
+	bOutSuccess &= !Ar.IsError();
+	return true;
+}
+
+FSavedMove_Survival::FSavedMove_Survival()
+{
+	DefaultAccelDotThresholdCombine = AccelDotThresholdCombine;
+}
+
+void FSavedMove_Survival::SetMoveFor(ACharacter* Character, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(Character, InDeltaTime, NewAccel, ClientData);
+
+	//the character moves with the acceleration saved here, so rounding it now keeps the client and server the same
+	if (const USurvivalCharacterMovement* Movement = Cast<USurvivalCharacterMovement>(Character->GetCharacterMovement()))
+	{
+		int8 Quantized[3];
+		Movement->QuantizeAcceleration(Acceleration, Quantized);
+		Acceleration = Movement->DequantizeAcceleration(Quantized);
+
+		//CanCombineWith compares these, so they have to be of the rounded acceleration too
+		AccelMag = Acceleration.Size();
+		AccelNormal = AccelMag > SMALL_NUMBER ? Acceleration / AccelMag : FVector::ZeroVector;
+
+		AccelDotThresholdCombine = bWantsToCrouch && !bPressedJump ? Movement->CrouchedAccelDotThresholdCombine : DefaultAccelDotThresholdCombine;
+	}
+}
+
+FNetworkPredictionData_Client_Survival::FNetworkPredictionData_Client_Survival(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_Survival::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_Survival());
+}
+
+USurvivalCharacterMovement::USurvivalCharacterMovement()
+{
+	MovesPerBatch = 4;
+	MaxBatchDelay = 0.05f;
+	CrouchedAccelDotThresholdCombine = 0.95f;
+
+	PendingBatchStartTime = 0.f;
+	LastMoveFlags = 0;
+	bInMoveRPC = false;
+}
+
+void USurvivalCharacterMovement::QuantizeAcceleration(const FVector& Accel, int8 OutAccel[3]) const
+{
+	const float MaxAccel = GetMaxAcceleration();
+
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		OutAccel[Axis] = MaxAccel > 0.f ? (int8)FMath::Clamp(FMath::RoundToInt(Accel[Axis] / MaxAccel * 127.f), -127, 127) : 0;
+	}
+}
+
+FVector USurvivalCharacterMovement::DequantizeAcceleration(const int8 Accel[3]) const
+{
+	const float MaxAccel = GetMaxAcceleration();
+	return FVector(Accel[0], Accel[1], Accel[2]) * (MaxAccel / 127.f);
+}
+
+FNetworkPredictionData_Client* USurvivalCharacterMovement::GetPredictionData_Client() const
+{
+	if (!ClientPredictionData)
+	{
+		USurvivalCharacterMovement* MutableThis = const_cast<USurvivalCharacterMovement*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_Survival(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+void USurvivalCharacterMovement::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	SURVIVAL_TICK_AUDIT_SCOPE();
+
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	//don't let a batch sit around waiting for more moves, e.g. while the game is hitching
+	if (PendingBatch.Moves.Num() > 0 && GetWorld()->TimeSince(PendingBatchStartTime) >= MaxBatchDelay)
+	{
+		SendMoveBatch();
+	}
+}
+
+void USurvivalCharacterMovement::CallServerMove(const FSavedMove_Character* NewMove, const FSavedMove_Character* OldMove)
+{
+	if (CVarPackedMoves.GetValueOnGameThread() == 0)
+	{
+		//anything still queued goes first, so the server gets the moves in order
+		SendMoveBatch();
+		Super::CallServerMove(NewMove, OldMove);
+		LastMoveFlags = NewMove->GetCompressedFlags();
+		return;
+	}
+
+	//make room for the pending and new move
+	if (PendingBatch.Moves.Num() + 2 > MaxPackedMoves)
+	{
+		SendMoveBatch();
+	}
+
+	//the engine picks the oldest important move the server hasn't acked. If we haven't sent it yet it goes in with the rest in order
+	if (OldMove && (PendingBatch.Moves.Num() == 0 || OldMove->TimeStamp < PendingBatch.Moves[0].TimeStamp))
+	{
+		PendingBatch.bHasOldMove = true;
+		PendingBatch.OldMove.TimeStamp = OldMove->TimeStamp;
+		PendingBatch.OldMove.Flags = OldMove->GetCompressedFlags();
+		QuantizeAcceleration(OldMove->Acceleration, PendingBatch.OldMove.Acceleration);
+	}
+
+	const int32 NumQueued = PendingBatch.Moves.Num();
+
+	//the engine holds a move back to send with the next one, and so do we
+	if (const FSavedMove_Character* PendingMove = GetPredictionData_Client_Character()->PendingMove.Get())
+	{
+		QueueMove(PendingMove);
+	}
+
+	QueueMove(NewMove);
+
+	//only the newest moves location gets checked, and the view it ended on is the one the server needs
+	UPrimitiveComponent* MovementBase = NewMove->EndBase.Get();
+	PendingBatch.ClientLoc = MovementBaseUtility::UseRelativeLocation(MovementBase) ? NewMove->SavedRelativeLocation : NewMove->SavedLocation;
+	PendingBatch.ClientRoll = FRotator::CompressAxisToByte(NewMove->SavedControlRotation.Roll);
+	PendingBatch.View = PackYawAndPitchTo32(NewMove->SavedControlRotation.Yaw, NewMove->SavedControlRotation.Pitch);
+	PendingBatch.ClientMovementBase = MovementBase;
+	PendingBatch.ClientBaseBoneName = NewMove->EndBoneName;
+	PendingBatch.ClientMovementMode = NewMove->EndPackedMovementMode;
+
+	if (NumQueued == 0)
+	{
+		PendingBatchStartTime = GetWorld()->GetTimeSeconds();
+	}
+
+	//crouching and jumping have to get to the server now rather than when the batch fills up, or it would feel laggy.
+	//Compared against the move before each one, which for the first move of a batch is the last one we sent
+	bool bFlagsChanged = false;
+	for (int32 i = NumQueued; i < PendingBatch.Moves.Num(); ++i)
+	{
+		bFlagsChanged |= PendingBatch.Moves[i].Flags != LastMoveFlags;
+		LastMoveFlags = PendingBatch.Moves[i].Flags;
+	}
+
+	if (bFlagsChanged || PendingBatch.Moves.Num() >= MovesPerBatch || GetWorld()->TimeSince(PendingBatchStartTime) >= MaxBatchDelay)
+	{
+		SendMoveBatch();
+	}
+}
+
+void USurvivalCharacterMovement::QueueMove(const FSavedMove_Character* Move)
+{
+	FSurvivalPackedMove& PackedMove = PendingBatch.Moves.AddDefaulted_GetRef();
+	PackedMove.TimeStamp = Move->TimeStamp;
+	PackedMove.Flags = Move->GetCompressedFlags();
+	QuantizeAcceleration(Move->Acceleration, PackedMove.Acceleration);
+}
+
+void USurvivalCharacterMovement::SendMoveBatch()
+{
+	if (PendingBatch.Moves.Num() == 0)
+	{
+		return;
+	}
+
+	if (ASurvivalCharacter* SurvivalCharacter = Cast<ASurvivalCharacter>(CharacterOwner))
+	{
+		SurvivalCharacter->ServerMovePacked(PendingBatch);
+	}
+
+	PendingBatch.Moves.Reset();
+	PendingBatch.bHasOldMove = false;
+}
+
+void USurvivalCharacterMovement::ServerMovePacked_Implementation(const FSurvivalMoveBatch& Batch)
+{
+	SURVIVAL_SCOPE_CYCLE_COUNTER(MovementRPC);
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	if (Batch.bHasOldMove)
+	{
+		Super::ServerMoveOld_Implementation(Batch.OldMove.TimeStamp, DequantizeAcceleration(Batch.OldMove.Acceleration), Batch.OldMove.Flags);
+	}
+
+	//every move but the newest is run like the first half of a ServerMoveDual, the client location is only checked at the end
+	for (int32 i = 0; i < Batch.Moves.Num(); ++i)
+	{
+		const FSurvivalPackedMove& Move = Batch.Moves[i];
+		const bool bNewest = i == Batch.Moves.Num() - 1;
+
+		Super::ServerMove_Implementation(Move.TimeStamp, DequantizeAcceleration(Move.Acceleration), bNewest ? FVector(Batch.ClientLoc) : NoClientLoc,
+			Move.Flags, Batch.ClientRoll, Batch.View, Batch.ClientMovementBase, Batch.ClientBaseBoneName, Batch.ClientMovementMode);
+	}
+
+	RecordServerMoves(StartTime, Batch.Moves.Num() + (Batch.bHasOldMove ? 1 : 0));
+}
+
+void USurvivalCharacterMovement::ServerMove_Implementation(float TimeStamp, FVector_NetQuantize10 InAccel, FVector_NetQuantize100 ClientLoc, uint8 CompressedMoveFlags, uint8 ClientRoll, uint32 View, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode)
+{
+	//ServerMoveDual runs its moves through here, it's already counting them
+	if (bInMoveRPC)
+	{
+		Super::ServerMove_Implementation(TimeStamp, InAccel, ClientLoc, CompressedMoveFlags, ClientRoll, View, ClientMovementBase, ClientBaseBoneName, ClientMovementMode);
+		return;
+	}
+
+	SURVIVAL_SCOPE_CYCLE_COUNTER(MovementRPC);
+
+	const double StartTime = FPlatformTime::Seconds();
+	TGuardValue<bool> MoveRPCGuard(bInMoveRPC, true);
+
+	Super::ServerMove_Implementation(TimeStamp, InAccel, ClientLoc, CompressedMoveFlags, ClientRoll, View, ClientMovementBase, ClientBaseBoneName, ClientMovementMode);
+
+	RecordServerMoves(StartTime, 1);
+}
+
+void USurvivalCharacterMovement::ServerMoveDual_Implementation(float TimeStamp0, FVector_NetQuantize10 InAccel0, uint8 PendingFlags, uint32 View0, float TimeStamp, FVector_NetQuantize10 InAccel, FVector_NetQuantize100 ClientLoc, uint8 NewFlags, uint8 ClientRoll, uint32 View, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode)
+{
+	SURVIVAL_SCOPE_CYCLE_COUNTER(MovementRPC);
+
+	const double StartTime = FPlatformTime::Seconds();
+	TGuardValue<bool> MoveRPCGuard(bInMoveRPC, true);
+
+	Super::ServerMoveDual_Implementation(TimeStamp0, InAccel0, PendingFlags, View0, TimeStamp, InAccel, ClientLoc, NewFlags, ClientRoll, View, ClientMovementBase, ClientBaseBoneName, ClientMovementMode);
+
+	RecordServerMoves(StartTime, 2);
+}
+
+void USurvivalCharacterMovement::ServerMoveOld_Implementation(float OldTimeStamp, FVector_NetQuantize10 OldAccel, uint8 OldMoveFlags)
+{
+	if (bInMoveRPC)
+	{
+		Super::ServerMoveOld_Implementation(OldTimeStamp, OldAccel, OldMoveFlags);
+		return;
+	}
+
+	SURVIVAL_SCOPE_CYCLE_COUNTER(MovementRPC);
+
+	const double StartTime = FPlatformTime::Seconds();
+	TGuardValue<bool> MoveRPCGuard(bInMoveRPC, true);
+
+	Super::ServerMoveOld_Implementation(OldTimeStamp, OldAccel, OldMoveFlags);
+
+	RecordServerMoves(StartTime, 1);
+}
+
+void USurvivalCharacterMovement::RecordServerMoves(const double StartTime, const int32 NumMoves) const
+{
+	SURVIVAL_INC_COUNTER(MovementRPCs, 1);
+	SURVIVAL_INC_COUNTER(MovementMoves, NumMoves);
+
+	ULoadTestMonitorComponent::RecordServerMoves(CharacterOwner, FPlatformTime::Seconds() - StartTime, NumMoves);
+}
@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "SurvivalCharacterMovement.generated.h"
+
+//Most moves a batch can carry, going by the bits its count is sent in
+static const int32 MaxPackedMoves = 15;
+
+//One saved move as it goes over the wire. Acceleration is a byte per axis of the max acceleration, see USurvivalCharacterMovement::QuantizeAcceleration
+struct FSurvivalPackedMove
+{
+	float TimeStamp = 0.f;
+	int8 Acceleration[3] = { 0, 0, 0 };
+	uint8 Flags = 0;
+};
+
+/**
+ * Several of a clients saved moves sent in a single ServerMovePacked, instead of one ServerMove or ServerMoveDual per send.
+ * Each move is its timestamp, its acceleration, and its crouch/jump flags, which are a single bit when they're the same as the
+ * move before. The view, client location and movement base are only sent for the newest move, which is the only one the
+ * server checks the client location against. The view is quantized to 12 bits of yaw and 10 of pitch.
+ */
+USTRUCT()
+struct FSurvivalMoveBatch
+{
+	GENERATED_BODY()
+
+	//Oldest first
+	TArray<FSurvivalPackedMove> Moves;
+
+	//An important move from before these that was already sent, sent again in case it was lost
+	bool bHasOldMove = false;
+	FSurvivalPackedMove OldMove;
+
+	FVector_NetQuantize100 ClientLoc;
+	uint8 ClientRoll = 0;
+	uint32 View = 0;
+	UPrimitiveComponent* ClientMovementBase = nullptr;
+	FName ClientBaseBoneName;
+	uint8 ClientMovementMode = 0;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FSurvivalMoveBatch> : public TStructOpsTypeTraitsBase2<FSurvivalMoveBatch>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+//Quantizes its acceleration as it's made, so the client moves with exactly what the server will get
+class FSavedMove_Survival : public FSavedMove_Character
+{
+public:
+
+	typedef FSavedMove_Character Super;
+
+	FSavedMove_Survival();
+
+	virtual void SetMoveFor(ACharacter* Character, float InDeltaTime, FVector const& NewAccel, class FNetworkPredictionData_Client_Character& ClientData) override;
+
+	//What the engine uses for moves that aren't crouched
+	float DefaultAccelDotThresholdCombine;
+};
+
+class FNetworkPredictionData_Client_Survival : public FNetworkPredictionData_Client_Character
+{
+public:
+
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_Survival(const UCharacterMovementComponent& ClientMovement);
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
+
+/**
+ * Character movement that sends its moves to the server a batch at a time with ServerMovePacked, instead of a ServerMove RPC for
+ * every send. Moves are queued until there are MovesPerBatch of them, MaxBatchDelay has passed, or the crouch or jump flags change,
+ * so a jump still gets to the server straight away. The server runs the whole batch in one go.
+ * Crouched moves combine with a looser direction check, a crouched player is slow enough that it doesn't show.
+ * "Survival.PackedMoves 0" on a client goes back to the engines RPCs, for comparing the two in a load test.
+ */
+UCLASS()
+class SURVIVALGAME_API USurvivalCharacterMovement : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	USurvivalCharacterMovement();
+
+	//How many moves to send at once. A batch can't carry more than MaxPackedMoves
+	UPROPERTY(EditDefaultsOnly, Category = "Character Movement (Networking)", meta = (ClampMin = 1, ClampMax = 8))
+	int32 MovesPerBatch;
+
+	//The longest a move can wait in a batch before it's sent anyway, in seconds
+	UPROPERTY(EditDefaultsOnly, Category = "Character Movement (Networking)", meta = (ClampMin = 0.0))
+	float MaxBatchDelay;
+
+	//How closely the acceleration of two crouched moves has to line up for them to combine into one. The engine uses 0.996 for everything
+	UPROPERTY(EditDefaultsOnly, Category = "Character Movement (Networking)", meta = (ClampMin = 0.0, ClampMax = 1.0))
+	float CrouchedAccelDotThresholdCombine;
+
+	//Round acceleration to what a packed move can carry
+	void QuantizeAcceleration(const FVector& Accel, int8 OutAccel[3]) const;
+	FVector DequantizeAcceleration(const int8 Accel[3]) const;
+
+	//[Server] Run every move in a batch from ServerMovePacked
+	void ServerMovePacked_Implementation(const FSurvivalMoveBatch& Batch);
+
+	//The engines move RPCs, timed so they can be compared against packed ones
+	virtual void ServerMove_Implementation(float TimeStamp, FVector_NetQuantize10 InAccel, FVector_NetQuantize100 ClientLoc, uint8 CompressedMoveFlags, uint8 ClientRoll, uint32 View, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) override;
+	virtual void ServerMoveDual_Implementation(float TimeStamp0, FVector_NetQuantize10 InAccel0, uint8 PendingFlags, uint32 View0, float TimeStamp, FVector_NetQuantize10 InAccel, FVector_NetQuantize100 ClientLoc, uint8 NewFlags, uint8 ClientRoll, uint32 View, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) override;
+	virtual void ServerMoveOld_Implementation(float OldTimeStamp, FVector_NetQuantize10 OldAccel, uint8 OldMoveFlags) override;
+
+	virtual class FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+protected:
+
+	//[Client] Queue the moves up instead of sending them
+	virtual void CallServerMove(const class FSavedMove_Character* NewMove, const class FSavedMove_Character* OldMove) override;
+
+	void QueueMove(const class FSavedMove_Character* Move);
+
+	//[Client] Send everything queued up
+	void SendMoveBatch();
+
+	//Time and count moves processed on the server, for the stats and the load test report
+	void RecordServerMoves(const double StartTime, const int32 NumMoves) const;
+
+	//[Client] Moves waiting to be sent, and the latest view and location to send with them
+	FSurvivalMoveBatch PendingBatch;
+
+	//[Client] World time the oldest queued move was made
+	float PendingBatchStartTime;
+
+	//[Client] Crouch and jump flags of the newest move we've queued or sent, so a change on the first move of a batch is still noticed
+	uint8 LastMoveFlags;
+
+	//Set while the server runs a move RPC, so the engine RPCs ServerMoveDual goes through aren't counted twice
+	bool bInMoveRPC;
+
+};
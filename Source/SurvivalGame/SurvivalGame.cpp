@@ -3,4 +3,46 @@
 #include "SurvivalGame.h"
 #include "Modules/ModuleManager.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, SurvivalGame, "SurvivalGame" );
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+DECLARE_LLM_MEMORY_STAT(TEXT("SurvivalItems"), STAT_SurvivalItemsLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("SurvivalInventory"), STAT_SurvivalInventoryLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("SurvivalInteraction"), STAT_SurvivalInteractionLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("SurvivalPickups"), STAT_SurvivalPickupsLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("SurvivalGame"), STAT_SurvivalGameSummaryLLM, STATGROUP_LLM);
+#endif
+
+class FSurvivalGameModule : public FDefaultGameModuleImpl
+{
+public:
+
+	virtual void StartupModule() override
+	{
+		//our tags have to be registered before anything is allocated under them
+		LLM(FLowLevelMemTracker::Get().RegisterProjectTag((int32)ESurvivalLLMTag::Items, TEXT("SurvivalItems"), GET_STATFNAME(STAT_SurvivalItemsLLM), GET_STATFNAME(STAT_SurvivalGameSummaryLLM)));
+		LLM(FLowLevelMemTracker::Get().RegisterProjectTag((int32)ESurvivalLLMTag::Inventory, TEXT("SurvivalInventory"), GET_STATFNAME(STAT_SurvivalInventoryLLM), GET_STATFNAME(STAT_SurvivalGameSummaryLLM)));
+		LLM(FLowLevelMemTracker::Get().RegisterProjectTag((int32)ESurvivalLLMTag::Interaction, TEXT("SurvivalInteraction"), GET_STATFNAME(STAT_SurvivalInteractionLLM), GET_STATFNAME(STAT_SurvivalGameSummaryLLM)));
+		LLM(FLowLevelMemTracker::Get().RegisterProjectTag((int32)ESurvivalLLMTag::Pickups, TEXT("SurvivalPickups"), GET_STATFNAME(STAT_SurvivalPickupsLLM), GET_STATFNAME(STAT_SurvivalGameSummaryLLM)));
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FSurvivalGameModule, SurvivalGame, "SurvivalGame" );
+
+CSV_DEFINE_CATEGORY_MODULE(SURVIVALGAME_API, SurvivalGame, true);
+
+DEFINE_STAT(STAT_InteractionCheck);
+DEFINE_STAT(STAT_InteractionFocus);
+DEFINE_STAT(STAT_InteractionRefreshWidget);
+DEFINE_STAT(STAT_InteractionRPC);
+DEFINE_STAT(STAT_InventoryMutation);
+DEFINE_STAT(STAT_InventoryReplication);
+DEFINE_STAT(STAT_MovementRPC);
+
+DEFINE_STAT(STAT_InteractionChecks);
+DEFINE_STAT(STAT_InteractionFocusChanges);
+DEFINE_STAT(STAT_InteractionWidgetRefreshes);
+DEFINE_STAT(STAT_InteractionRPCs);
+DEFINE_STAT(STAT_InventoryMutations);
+DEFINE_STAT(STAT_InventoryItemsReplicated);
+DEFINE_STAT(STAT_InventoryBytesReplicated);
+DEFINE_STAT(STAT_MovementRPCs);
+DEFINE_STAT(STAT_MovementMoves);
@@ -3,4 +3,54 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "HAL/LowLevelMemTracker.h"
 
+//Hot path stats, see them with "stat SurvivalGame", or in a csv capture with "csvprofile start" / -csvCaptureFrames on a server
+DECLARE_STATS_GROUP(TEXT("SurvivalGame"), STATGROUP_SurvivalGame, STATCAT_Advanced);
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(SURVIVALGAME_API, SurvivalGame);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Interaction Check"), STAT_InteractionCheck, STATGROUP_SurvivalGame, SURVIVALGAME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Interaction Focus"), STAT_InteractionFocus, STATGROUP_SurvivalGame, SURVIVALGAME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Interaction Refresh Widget"), STAT_InteractionRefreshWidget, STATGROUP_SurvivalGame, SURVIVALGAME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Interaction RPCs"), STAT_InteractionRPC, STATGROUP_SurvivalGame, SURVIVALGAME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Inventory Mutation"), STAT_InventoryMutation, STATGROUP_SurvivalGame, SURVIVALGAME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Inventory Replication"), STAT_InventoryReplication, STATGROUP_SurvivalGame, SURVIVALGAME_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Movement RPCs"), STAT_MovementRPC, STATGROUP_SurvivalGame, SURVIVALGAME_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Interaction Checks"), STAT_InteractionChecks, STATGROUP_SurvivalGame, SURVIVALGAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Interaction Focus Changes"), STAT_InteractionFocusChanges, STATGROUP_SurvivalGame, SURVIVALGAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Interaction Widget Refreshes"), STAT_InteractionWidgetRefreshes, STATGROUP_SurvivalGame, SURVIVALGAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Interaction RPCs Received"), STAT_InteractionRPCs, STATGROUP_SurvivalGame, SURVIVALGAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Inventory Mutations"), STAT_InventoryMutations, STATGROUP_SurvivalGame, SURVIVALGAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Inventory Items Replicated"), STAT_InventoryItemsReplicated, STATGROUP_SurvivalGame, SURVIVALGAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Inventory Bytes Replicated"), STAT_InventoryBytesReplicated, STATGROUP_SurvivalGame, SURVIVALGAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Movement RPCs Received"), STAT_MovementRPCs, STATGROUP_SurvivalGame, SURVIVALGAME_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Movement Moves Received"), STAT_MovementMoves, STATGROUP_SurvivalGame, SURVIVALGAME_API);
+
+//Times the rest of the scope into both the stat system and csv captures. Takes the stat name without the STAT_ prefix
+#define SURVIVAL_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(STAT_##Stat); \
+	CSV_SCOPED_TIMING_STAT(SurvivalGame, Stat)
+
+//Adds to a per frame counter in both the stat system and csv captures
+#define SURVIVAL_INC_COUNTER(Stat, Amount) \
+	INC_DWORD_STAT_BY(STAT_##Stat, Amount); \
+	CSV_CUSTOM_STAT(SurvivalGame, Stat, (int32)(Amount), ECsvCustomStatOp::Accumulate)
+
+//Low level memory tracker tags for the world item memory, see them with -llm and "stat LLMFULL"
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+enum class ESurvivalLLMTag : int32
+{
+	Items = (int32)ELLMTag::ProjectTagStart,
+	Inventory,
+	Interaction,
+	Pickups
+};
+
+//Counts allocations made in the rest of the scope against one of the ESurvivalLLMTags
+#define SURVIVAL_LLM_SCOPE(Tag) LLM_SCOPE((ELLMTag)ESurvivalLLMTag::Tag)
+#else
+#define SURVIVAL_LLM_SCOPE(Tag)
+#endif
@@ -6,6 +6,8 @@
 
 void UInteractionWidget::UpdateInteractionWidget(class UInteractionComponent* InteractionComponent)
 {
+#if !UE_SERVER
 	OwningInteractionComponent = InteractionComponent;
 	OnUpdateInteractionWidget();
+#endif
 }
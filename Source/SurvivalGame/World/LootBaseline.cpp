@@ -0,0 +1,241 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LootBaseline.h"
+#include "Misc/Compression.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace LootBaseline
+{
+	//bytes an entry takes before compression, anything claiming more entries than the data could hold is garbage
+	static const int64 EntryBytes = 13;
+
+	static uint16 QuantizeAxis(const float Value, const float Min, const float Max)
+	{
+		const float Alpha = Max > Min ? (Value - Min) / (Max - Min) : 0.f;
+		return (uint16)FMath::RoundToInt(FMath::Clamp(Alpha, 0.f, 1.f) * MAX_uint16);
+	}
+
+	static float DequantizeAxis(const uint16 Value, const float Min, const float Max)
+	{
+		return FMath::Lerp(Min, Max, Value / (float)MAX_uint16);
+	}
+
+	static void WriteEntries(FArchive& Writer, const FBox& Bounds, const TArray<FEntry>& Entries)
+	{
+		FBox WriteBounds = Bounds;
+		int32 NumEntries = Entries.Num();
+		Writer << WriteBounds;
+		Writer << NumEntries;
+
+		TArray<FQuantizedEntry> Quantized;
+		Quantized.Reserve(Entries.Num());
+
+		for (const FEntry& Entry : Entries)
+		{
+			Quantized.Add(Quantize(Bounds, Entry));
+		}
+
+		//one field at a time across every entry, so similar bytes sit next to each other and compress better
+		for (FQuantizedEntry& Entry : Quantized)
+		{
+			Writer << Entry.ItemId;
+		}
+
+		for (FQuantizedEntry& Entry : Quantized)
+		{
+			Writer << Entry.Quantity;
+		}
+
+		for (FQuantizedEntry& Entry : Quantized)
+		{
+			Writer << Entry.X << Entry.Y << Entry.Z;
+		}
+
+		for (FQuantizedEntry& Entry : Quantized)
+		{
+			Writer << Entry.Pitch << Entry.Yaw << Entry.Roll;
+		}
+	}
+
+	static bool ReadEntries(FArchive& Reader, const int32 DataSize, FBox& OutBounds, TArray<FEntry>& OutEntries)
+	{
+		int32 NumEntries = 0;
+		Reader << OutBounds;
+		Reader << NumEntries;
+
+		if (Reader.IsError() || NumEntries < 0 || NumEntries * EntryBytes > DataSize)
+		{
+			return false;
+		}
+
+		OutEntries.SetNum(NumEntries);
+
+		for (FEntry& Entry : OutEntries)
+		{
+			Reader << Entry.ItemId;
+		}
+
+		for (FEntry& Entry : OutEntries)
+		{
+			Reader << Entry.Quantity;
+		}
+
+		for (FEntry& Entry : OutEntries)
+		{
+			uint16 X = 0, Y = 0, Z = 0;
+			Reader << X << Y << Z;
+			Entry.Transform.SetLocation(FVector(DequantizeAxis(X, OutBounds.Min.X, OutBounds.Max.X), DequantizeAxis(Y, OutBounds.Min.Y, OutBounds.Max.Y), DequantizeAxis(Z, OutBounds.Min.Z, OutBounds.Max.Z)));
+		}
+
+		for (FEntry& Entry : OutEntries)
+		{
+			uint8 Pitch = 0, Yaw = 0, Roll = 0;
+			Reader << Pitch << Yaw << Roll;
+			Entry.Transform.SetRotation(FRotator(FRotator::DecompressAxisFromByte(Pitch), FRotator::DecompressAxisFromByte(Yaw), FRotator::DecompressAxisFromByte(Roll)).Quaternion());
+			Entry.Transform.SetScale3D(FVector::OneVector);
+		}
+
+		return !Reader.IsError();
+	}
+
+	static void Compress(TArray<uint8>& Uncompressed, TArray<uint8>& OutCompressed, int32& OutUncompressedSize)
+	{
+		OutUncompressedSize = Uncompressed.Num();
+
+		int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, OutUncompressedSize);
+		OutCompressed.SetNumUninitialized(CompressedSize);
+
+		if (FCompression::CompressMemory(NAME_Zlib, OutCompressed.GetData(), CompressedSize, Uncompressed.GetData(), OutUncompressedSize))
+		{
+			OutCompressed.SetNum(CompressedSize);
+		}
+		else
+		{
+			//shouldnt happen, but sending it uncompressed is better than not at all
+			OutCompressed = MoveTemp(Uncompressed);
+			OutUncompressedSize = -OutUncompressedSize;
+		}
+	}
+
+	static bool Uncompress(const TArray<uint8>& Compressed, const int32 UncompressedSize, TArray<uint8>& OutUncompressed)
+	{
+		//a negative size means Encode couldnt compress it
+		if (UncompressedSize < 0)
+		{
+			OutUncompressed = Compressed;
+			return true;
+		}
+
+		OutUncompressed.SetNumUninitialized(UncompressedSize);
+		return FCompression::UncompressMemory(NAME_Zlib, OutUncompressed.GetData(), UncompressedSize, Compressed.GetData(), Compressed.Num());
+	}
+}
+
+LootBaseline::FQuantizedEntry LootBaseline::Quantize(const FBox& Bounds, const FEntry& Entry)
+{
+	const FVector Location = Entry.Transform.GetLocation();
+	const FRotator Rotation = Entry.Transform.Rotator();
+
+	FQuantizedEntry Quantized;
+	Quantized.ItemId = Entry.ItemId;
+	Quantized.Quantity = Entry.Quantity;
+	Quantized.X = QuantizeAxis(Location.X, Bounds.Min.X, Bounds.Max.X);
+	Quantized.Y = QuantizeAxis(Location.Y, Bounds.Min.Y, Bounds.Max.Y);
+	Quantized.Z = QuantizeAxis(Location.Z, Bounds.Min.Z, Bounds.Max.Z);
+	Quantized.Pitch = FRotator::CompressAxisToByte(Rotation.Pitch);
+	Quantized.Yaw = FRotator::CompressAxisToByte(Rotation.Yaw);
+	Quantized.Roll = FRotator::CompressAxisToByte(Rotation.Roll);
+	return Quantized;
+}
+
+void LootBaseline::Encode(const FBox& Bounds, const TArray<FEntry>& Entries, TArray<uint8>& OutCompressed, int32& OutUncompressedSize)
+{
+	TArray<uint8> Uncompressed;
+	FMemoryWriter Writer(Uncompressed);
+
+	WriteEntries(Writer, Bounds, Entries);
+	Compress(Uncompressed, OutCompressed, OutUncompressedSize);
+}
+
+bool LootBaseline::Decode(const TArray<uint8>& Compressed, const int32 UncompressedSize, FBox& OutBounds, TArray<FEntry>& OutEntries)
+{
+	TArray<uint8> Uncompressed;
+
+	if (!Uncompress(Compressed, UncompressedSize, Uncompressed))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Uncompressed);
+	return ReadEntries(Reader, Uncompressed.Num(), OutBounds, OutEntries);
+}
+
+void LootBaseline::EncodeDelta(const FBox& Bounds, const TArray<int32>& Removed, const TArray<FEntry>& Added, TArray<uint8>& OutCompressed, int32& OutUncompressedSize)
+{
+	TArray<uint8> Uncompressed;
+	FMemoryWriter Writer(Uncompressed);
+
+	int32 NumRemoved = Removed.Num();
+	Writer << NumRemoved;
+
+	for (int32 Index : Removed)
+	{
+		Writer << Index;
+	}
+
+	WriteEntries(Writer, Bounds, Added);
+	Compress(Uncompressed, OutCompressed, OutUncompressedSize);
+}
+
+bool LootBaseline::DecodeDelta(const TArray<uint8>& Compressed, const int32 UncompressedSize, FBox& OutBounds, TArray<int32>& OutRemoved, TArray<FEntry>& OutAdded)
+{
+	TArray<uint8> Uncompressed;
+
+	if (!Uncompress(Compressed, UncompressedSize, Uncompressed))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Uncompressed);
+
+	int32 NumRemoved = 0;
+	Reader << NumRemoved;
+
+	if (Reader.IsError() || NumRemoved < 0 || NumRemoved * (int64)sizeof(int32) > Uncompressed.Num())
+	{
+		return false;
+	}
+
+	OutRemoved.SetNum(NumRemoved);
+
+	for (int32& Index : OutRemoved)
+	{
+		Reader << Index;
+	}
+
+	return !Reader.IsError() && ReadEntries(Reader, Uncompressed.Num(), OutBounds, OutAdded);
+}
+
+bool LootBaseline::ApplyDelta(TArray<FEntry>& Entries, TArray<int32> Removed, const TArray<FEntry>& Added)
+{
+	//highest first, so removing one doesn't move the ones still to go
+	Removed.Sort([](const int32 A, const int32 B) { return A > B; });
+
+	for (int32 i = 0; i < Removed.Num(); ++i)
+	{
+		if (!Entries.IsValidIndex(Removed[i]) || (i > 0 && Removed[i] == Removed[i - 1]))
+		{
+			return false;
+		}
+	}
+
+	for (const int32 Index : Removed)
+	{
+		Entries.RemoveAt(Index, 1, false);
+	}
+
+	Entries.Append(Added);
+	return true;
+}
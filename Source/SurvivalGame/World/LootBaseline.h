@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Packs the loot lying in a region into a compressed blob that can be sent to a joining player in a few chunks, instead of
+ * one actor channel per pickup. Each entry is an item id, a quantity and a transform quantized against the region bounds:
+ * 16 bits per axis for location and a byte per axis for rotation, 13 bytes in all before compression.
+ * Once a client has a region, changes to it are sent as deltas: the indices of entries that went away and the entries that were
+ * added, applied on top of the version the client has. Both sides keep entries in the same order for that, kept ones first,
+ * in their old order, then new ones.
+ * Only spawner loot is in here. Loot containers are placed in the level and replicate as actors, and until someone opens one it's
+ * just a loot table and a seed, so there's nothing to send. Decay timing stays on the server with the region's dormant placements.
+ */
+namespace LootBaseline
+{
+	struct FEntry
+	{
+		uint16 ItemId;
+		uint16 Quantity;
+		FTransform Transform;
+	};
+
+	//An entry as it's sent. Two entries that quantize the same look exactly the same to a client
+	struct FQuantizedEntry
+	{
+		uint16 ItemId;
+		uint16 Quantity;
+		uint16 X, Y, Z;
+		uint8 Pitch, Yaw, Roll;
+
+		bool operator==(const FQuantizedEntry& Other) const
+		{
+			return ItemId == Other.ItemId && Quantity == Other.Quantity && X == Other.X && Y == Other.Y && Z == Other.Z && Pitch == Other.Pitch && Yaw == Other.Yaw && Roll == Other.Roll;
+		}
+
+		friend uint32 GetTypeHash(const FQuantizedEntry& Entry)
+		{
+			return HashCombine(HashCombine(Entry.ItemId | (Entry.Quantity << 16), Entry.X | (Entry.Y << 16)), Entry.Z | (Entry.Pitch << 16) | (Entry.Yaw << 24)) ^ Entry.Roll;
+		}
+	};
+
+	SURVIVALGAME_API FQuantizedEntry Quantize(const FBox& Bounds, const FEntry& Entry);
+
+	//Quantize and compress a regions loot. OutUncompressedSize is needed to decode it again
+	SURVIVALGAME_API void Encode(const FBox& Bounds, const TArray<FEntry>& Entries, TArray<uint8>& OutCompressed, int32& OutUncompressedSize);
+
+	//Undo Encode. False if the data is corrupt
+	SURVIVALGAME_API bool Decode(const TArray<uint8>& Compressed, const int32 UncompressedSize, FBox& OutBounds, TArray<FEntry>& OutEntries);
+
+	//Quantize and compress the change from one version of a region to the next, Removed are indices into the old entries
+	SURVIVALGAME_API void EncodeDelta(const FBox& Bounds, const TArray<int32>& Removed, const TArray<FEntry>& Added, TArray<uint8>& OutCompressed, int32& OutUncompressedSize);
+
+	//Undo EncodeDelta. False if the data is corrupt
+	SURVIVALGAME_API bool DecodeDelta(const TArray<uint8>& Compressed, const int32 UncompressedSize, FBox& OutBounds, TArray<int32>& OutRemoved, TArray<FEntry>& OutAdded);
+
+	//Remove and add a delta's entries the same way on both sides, so they keep agreeing on the order. False, and Entries left alone,
+	//if an index is out of range or repeated
+	SURVIVALGAME_API bool ApplyDelta(TArray<FEntry>& Entries, TArray<int32> Removed, const TArray<FEntry>& Added);
+}
@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LootContainer.h"
+#include "LootTable.h"
+#include "Components/StaticMeshComponent.h"
+#include "Components/InteractionComponent.h"
+#include "Components/InventoryComponent.h"
+#include "Components/LootSpawnerComponent.h"
+#include "Framework/SurvivalGameGameModeBase.h"
+#include "Net/UnrealNetwork.h"
+#include "TimerManager.h"
+
+// Sets default values
+ALootContainer::ALootContainer()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	ContainerMesh = CreateDefaultSubobject<UStaticMeshComponent>("ContainerMesh");
+	ContainerMesh->SetCollisionResponseToChannel(ECC_Visibility, ECR_Block);
+
+	SetRootComponent(ContainerMesh);
+
+	InteractionComponent = CreateDefaultSubobject<UInteractionComponent>("ContainerInteractionComponent");
+	InteractionComponent->InteractionTime = 0.5f;
+	InteractionComponent->InteractionDistance = 200.f;
+	InteractionComponent->InteractableNameText = FText::FromString("Container");
+	InteractionComponent->InteractableActionText = FText::FromString("Open");
+	InteractionComponent->SetupAttachment(ContainerMesh);
+	InteractionComponent->OnBeginInteract.AddDynamic(this, &ALootContainer::OnBeginOpen);
+
+	LootTable = nullptr;
+	LootSeed = 0;
+	MinItems = 1;
+	MaxItems = 4;
+	CollapseTimeout = 300.f;
+	GeneratedItemsKey = 0;
+
+	bReplicates = true;
+}
+
+// Called when the game starts or when spawned
+void ALootContainer::BeginPlay()
+{
+	Super::BeginPlay();
+
+	//containers placed in the level keep their name between runs, so this gives every one its own stable loot
+	if (LootSeed == 0)
+	{
+		LootSeed = (int32)GetTypeHash(GetName());
+	}
+}
+
+void ALootContainer::GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ALootContainer, Inventory);
+}
+
+void ALootContainer::OnBeginOpen(class ASurvivalCharacter* Character)
+{
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	if (!Inventory)
+	{
+		GenerateLoot();
+	}
+
+	//someone is looking at the loot, give them the full timeout again before we consider collapsing it
+	if (Inventory && CollapseTimeout > 0.f)
+	{
+		GetWorldTimerManager().SetTimer(TimerHandle_Collapse, this, &ALootContainer::TryCollapseLoot, CollapseTimeout, false);
+	}
+}
+
+void ALootContainer::GenerateLoot()
+{
+	ASurvivalGameGameModeBase* GameMode = GetWorld()->GetAuthGameMode<ASurvivalGameGameModeBase>();
+
+	if (!GameMode || !GameMode->LootSpawner)
+	{
+		return;
+	}
+
+	Inventory = NewObject<UInventoryComponent>(this);
+	Inventory->RegisterComponent();
+
+	//same seed, same table, same loot, however many times the container is collapsed and reopened
+	TSharedPtr<const FCompiledLootTable, ESPMode::ThreadSafe> CompiledLootTable = GameMode->LootSpawner->GetCompiledLootTable(LootTable);
+	const FRandomStream Stream(LootSeed);
+	const int32 NumItems = Stream.RandRange(MinItems, FMath::Max(MinItems, MaxItems));
+
+	for (int32 i = 0; i < NumItems; ++i)
+	{
+		int32 Quantity = 0;
+		if (const FCompiledLootTable::FEntry* Entry = CompiledLootTable->Sample(Stream, Quantity))
+		{
+			Inventory->TryAddItemFromClass(Entry->Item, Quantity);
+		}
+	}
+
+	GeneratedItemsKey = Inventory->GetReplicatedItemsKey();
+}
+
+void ALootContainer::TryCollapseLoot()
+{
+	if (!Inventory)
+	{
+		return;
+	}
+
+	//somebody took or added something, so this container's contents are real now and are kept for good
+	if (Inventory->GetReplicatedItemsKey() != GeneratedItemsKey)
+	{
+		return;
+	}
+
+	Inventory->DestroyComponent();
+	Inventory = nullptr;
+}
@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "LootContainer.generated.h"
+
+/**
+ * A crate, cupboard or anything else that holds loot. Until a player first begins interacting with it, a container only
+ * stores its loot table and seed, it has no inventory and no items. The inventory is created and filled deterministically
+ * from the seed on the server the first time it's opened. If nobody takes anything out within CollapseTimeout, the inventory
+ * is thrown away again, and the next player to open it gets exactly the same loot regenerated from the seed.
+ */
+UCLASS(ClassGroup = (Items), Blueprintable)
+class SURVIVALGAME_API ALootContainer : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ALootContainer();
+
+	UPROPERTY(EditAnywhere, Category = "Components")
+	class UStaticMeshComponent* ContainerMesh;
+
+	UPROPERTY(EditAnywhere, Category = "Components")
+	class UInteractionComponent* InteractionComponent;
+
+	//Data table of FLootTableRow to fill the container from
+	UPROPERTY(EditAnywhere, Category = "Loot")
+	class UDataTable* LootTable;
+
+	//The seed the loot is generated from. Zero means derive one from the containers name
+	UPROPERTY(EditAnywhere, Category = "Loot")
+	int32 LootSeed;
+
+	//The range for how many items the container is filled with
+	UPROPERTY(EditAnywhere, Category = "Loot", meta = (ClampMin = 0))
+	int32 MinItems;
+
+	UPROPERTY(EditAnywhere, Category = "Loot", meta = (ClampMin = 0))
+	int32 MaxItems;
+
+	//How long in seconds after being opened an untouched container drops its items and goes back to just a seed. Zero means never
+	UPROPERTY(EditAnywhere, Category = "Loot", meta = (ClampMin = 0.0))
+	float CollapseTimeout;
+
+	//The containers inventory, null until someone has opened it
+	UFUNCTION(BlueprintPure, Category = "Loot")
+	FORCEINLINE class UInventoryComponent* GetInventory() const { return Inventory; }
+
+protected:
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
+
+	UFUNCTION()
+	void OnBeginOpen(class ASurvivalCharacter* Character);
+
+	//[Server] Create the inventory and fill it from the loot table and seed
+	void GenerateLoot();
+
+	//[Server] Throw the inventory away if nobody has changed it since it was generated
+	void TryCollapseLoot();
+
+	UPROPERTY(Replicated, BlueprintReadOnly, Category = "Loot")
+	class UInventoryComponent* Inventory;
+
+	//The inventory's items key straight after generating, if it's still the same nothing has been taken or added
+	int32 GeneratedItemsKey;
+
+	FTimerHandle TimerHandle_Collapse;
+
+};
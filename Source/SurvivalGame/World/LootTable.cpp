@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "LootTable.h"
+
+void FLootAliasTable::Build(const TArray<float>& Weights)
+{
+	Probabilities.Reset();
+	Aliases.Reset();
+
+	const int32 NumWeights = Weights.Num();
+
+	float TotalWeight = 0.f;
+	for (const float Weight : Weights)
+	{
+		TotalWeight += FMath::Max(Weight, 0.f);
+	}
+
+	if (NumWeights == 0 || TotalWeight <= 0.f)
+	{
+		return;
+	}
+
+	Probabilities.SetNumUninitialized(NumWeights);
+	Aliases.SetNumUninitialized(NumWeights);
+
+	//scale the weights so the average column is exactly 1, then split them into the columns that are under and over full
+	TArray<float> Scaled;
+	Scaled.SetNumUninitialized(NumWeights);
+
+	TArray<int32> Small;
+	TArray<int32> Large;
+	Small.Reserve(NumWeights);
+	Large.Reserve(NumWeights);
+
+	for (int32 i = 0; i < NumWeights; ++i)
+	{
+		Scaled[i] = FMath::Max(Weights[i], 0.f) * NumWeights / TotalWeight;
+		(Scaled[i] < 1.f ? Small : Large).Add(i);
+	}
+
+	//top up each under full column with part of an over full one, which becomes its alias
+	while (Small.Num() > 0 && Large.Num() > 0)
+	{
+		const int32 Less = Small.Pop(false);
+		const int32 More = Large.Pop(false);
+
+		Probabilities[Less] = Scaled[Less];
+		Aliases[Less] = More;
+
+		Scaled[More] = (Scaled[More] + Scaled[Less]) - 1.f;
+		(Scaled[More] < 1.f ? Small : Large).Add(More);
+	}
+
+	//whatever is left is full, give or take floating point error
+	for (const int32 Index : Large)
+	{
+		Probabilities[Index] = 1.f;
+		Aliases[Index] = Index;
+	}
+
+	for (const int32 Index : Small)
+	{
+		Probabilities[Index] = 1.f;
+		Aliases[Index] = Index;
+	}
+}
+
+int32 FLootAliasTable::Sample(const FRandomStream& Stream) const
+{
+	if (IsEmpty())
+	{
+		return INDEX_NONE;
+	}
+
+	const int32 Column = Stream.RandHelper(Probabilities.Num());
+	return Stream.GetFraction() < Probabilities[Column] ? Column : Aliases[Column];
+}
+
+void FCompiledLootTable::Compile(const UDataTable* LootTable, const TMap<EItemRarity, float>& RarityWeights)
+{
+	Entries.Reset();
+
+	TArray<float> Weights;
+
+	if (LootTable)
+	{
+		static const FString ContextString(TEXT("Compile Loot Table"));
+
+		TArray<FLootTableRow*> Rows;
+		LootTable->GetAllRows<FLootTableRow>(ContextString, Rows);
+
+		for (const FLootTableRow* Row : Rows)
+		{
+			if (!Row || !Row->Item)
+			{
+				continue;
+			}
+
+			const EItemRarity Rarity = Row->Item->GetDefaultObject<UItem>()->Rarity;
+
+			FEntry& Entry = Entries.AddDefaulted_GetRef();
+			Entry.Item = Row->Item;
+			Entry.MinQuantity = FMath::Max(Row->MinQuantity, 1);
+			Entry.MaxQuantity = FMath::Max(Row->MaxQuantity, Entry.MinQuantity);
+
+			Weights.Add(RarityWeights.FindRef(Rarity) * Row->WeightMultiplier);
+		}
+	}
+
+	AliasTable.Build(Weights);
+}
+
+const FCompiledLootTable::FEntry* FCompiledLootTable::Sample(const FRandomStream& Stream, int32& OutQuantity) const
+{
+	const int32 Index = AliasTable.Sample(Stream);
+
+	if (!Entries.IsValidIndex(Index))
+	{
+		return nullptr;
+	}
+
+	const FEntry& Entry = Entries[Index];
+	OutQuantity = Stream.RandRange(Entry.MinQuantity, Entry.MaxQuantity);
+	return &Entry;
+}
@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "Items/Item.h"
+#include "LootTable.generated.h"
+
+//A single entry in a loot table. How often it is picked depends on the rarity of the item and the weight multiplier
+USTRUCT(BlueprintType)
+struct FLootTableRow : public FTableRowBase
+{
+	GENERATED_BODY()
+
+	FLootTableRow()
+	{
+		MinQuantity = 1;
+		MaxQuantity = 1;
+		WeightMultiplier = 1.f;
+	}
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Loot")
+	TSubclassOf<class UItem> Item;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Loot", meta = (ClampMin = 1))
+	int32 MinQuantity;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Loot", meta = (ClampMin = 1))
+	int32 MaxQuantity;
+
+	//Scales the rarity weight, e.g. to make one common item show up more than the others
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Loot", meta = (ClampMin = 0.0))
+	float WeightMultiplier;
+};
+
+/**
+ * Walker/Vose alias table. Built once in O(n) from a list of weights, then picks a weighted index in O(1) with
+ * one random column and one random coin flip, no matter how many entries there are.
+ */
+struct SURVIVALGAME_API FLootAliasTable
+{
+	void Build(const TArray<float>& Weights);
+
+	int32 Sample(const FRandomStream& Stream) const;
+
+	FORCEINLINE bool IsEmpty() const { return Probabilities.Num() == 0; }
+
+private:
+
+	//The chance of keeping each column rather than taking its alias
+	TArray<float> Probabilities;
+	TArray<int32> Aliases;
+};
+
+//A loot table flattened into plain data, so worker threads can sample it without touching any UObjects
+struct SURVIVALGAME_API FCompiledLootTable
+{
+	struct FEntry
+	{
+		TSubclassOf<class UItem> Item;
+		int32 MinQuantity;
+		int32 MaxQuantity;
+	};
+
+	TArray<FEntry> Entries;
+	FLootAliasTable AliasTable;
+
+	//Build from a data table of FLootTableRow, weighting each row by its items rarity. Game thread only
+	void Compile(const class UDataTable* LootTable, const TMap<EItemRarity, float>& RarityWeights);
+
+	//Pick an entry and a quantity for it. Safe to call from any thread
+	const FEntry* Sample(const FRandomStream& Stream, int32& OutQuantity) const;
+};
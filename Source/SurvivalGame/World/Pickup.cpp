@@ -0,0 +1,225 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Pickup.h"
+#include "SurvivalGame.h"
+#include "Items/Item.h"
+#include "Components/StaticMeshComponent.h"
+#include "Components/InteractionComponent.h"
+#include "Components/InventoryComponent.h"
+#include "Components/ItemLifecycleComponent.h"
+#include "Framework/SurvivalMemoryReport.h"
+#include "Player/SurvivalCharacter.h"
+#include "Engine/ActorChannel.h"
+#include "Net/UnrealNetwork.h"
+
+// Sets default values
+APickup::APickup()
+{
+	//pickups never need to tick, everything they do is driven by interaction and replication
+	PrimaryActorTick.bCanEverTick = false;
+
+	PickupMesh = CreateDefaultSubobject<UStaticMeshComponent>("PickupMesh");
+	//interaction check is a visibility trace, so the mesh must block it
+	PickupMesh->SetCollisionResponseToChannel(ECC_Visibility, ECR_Block);
+
+	SetRootComponent(PickupMesh);
+
+	InteractionComponent = CreateDefaultSubobject<UInteractionComponent>("PickupInteractionComponent");
+	InteractionComponent->InteractionTime = 0.5f;
+	InteractionComponent->InteractionDistance = 200.f;
+	InteractionComponent->InteractableNameText = FText::FromString("Pickup");
+	InteractionComponent->InteractableActionText = FText::FromString("Take");
+	InteractionComponent->SetupAttachment(PickupMesh);
+	InteractionComponent->OnInteract.AddDynamic(this, &APickup::OnTakePickup);
+
+	DespawnTime = 0.f;
+	bIgnoreDespawnTime = false;
+
+	bReplicates = true;
+}
+
+void APickup::InitializePickup(const TSubclassOf<class UItem> ItemClass, const int32 Quantity, const float NextDecayTime)
+{
+	if (HasAuthority() && ItemClass && Quantity > 0)
+	{
+		SURVIVAL_LLM_SCOPE(Items);
+
+		Item = NewObject<UItem>(this, ItemClass);
+		Item->SetQuantity(Quantity);
+		Item->NextDecayTime = NextDecayTime;
+
+		//server doesnt get rep notifies, so call it ourselves
+		OnRep_Item();
+
+		Item->MarkDirtyForReplication();
+
+		if (UItemLifecycleComponent* ItemLifecycle = UItemLifecycleComponent::Get(this))
+		{
+			ItemLifecycle->ScheduleDecay(Item);
+		}
+	}
+}
+
+void APickup::OnRep_Item()
+{
+	if (Item)
+	{
+		PickupMesh->SetStaticMesh(Item->PickupMesh);
+		InteractionComponent->InteractableNameText = Item->ItemDisplayName;
+
+		//clients bind to this so the interaction card updates if the quantity changes
+		Item->OnItemModified.AddDynamic(this, &APickup::OnItemModified);
+	}
+
+	InteractionComponent->RefreshWidget();
+}
+
+void APickup::OnItemModified()
+{
+	if (InteractionComponent)
+	{
+		InteractionComponent->RefreshWidget();
+	}
+}
+
+void APickup::OnTakePickup(class ASurvivalCharacter* Taker)
+{
+	if (!Taker)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Pickup was taken but player was not valid."));
+		return;
+	}
+
+	if (HasAuthority())
+	{
+		const FItemAddResult AddResult = TakePickup(Taker->PlayerInventory);
+
+		//let the taker know how their predicted pickup turned out
+		if (Taker->PlayerInventory && Taker->GetInteractionPredictionKey() > 0)
+		{
+			Taker->PlayerInventory->AckPrediction(Taker->GetInteractionPredictionKey(), AddResult.Result == EItemAddResult::IAR_AllItemsAdded);
+		}
+	}
+	else if (Taker->IsLocallyControlled() && Item && Taker->PlayerInventory)
+	{
+		//dont wait a round trip to see the item move into the inventory
+		if (Taker->PlayerInventory->AddPredictedItem(Item->GetClass(), Item->GetQuantity(), Taker->GetInteractionPredictionKey(), this))
+		{
+			SetPredictedTaken(true);
+		}
+	}
+}
+
+void APickup::SetPredictedTaken(const bool bTaken)
+{
+	//without collision the interaction trace goes straight through it, so it can't be focused or taken twice
+	SetActorHiddenInGame(bTaken);
+	SetActorEnableCollision(!bTaken);
+}
+
+FItemAddResult APickup::TakePickup(class UInventoryComponent* Inventory)
+{
+	//pending kill check stops a second player taking a pickup someone else already took this frame
+	if (!HasAuthority() || IsPendingKill() || !Item || !Inventory)
+	{
+		return FItemAddResult::AddedNone(0, FText::GetEmpty());
+	}
+
+	const FItemAddResult AddResult = Inventory->TryAddItem(Item);
+
+	//leave whatever didnt fit on the ground
+	if (AddResult.ActualAmountGiven < Item->GetQuantity())
+	{
+		Item->SetQuantity(Item->GetQuantity() - AddResult.ActualAmountGiven);
+	}
+	else
+	{
+		Destroy();
+	}
+
+	return AddResult;
+}
+
+void APickup::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	SurvivalMemory::TrackCreated(this, SurvivalMemory::ECategory::Pickups);
+}
+
+void APickup::BeginDestroy()
+{
+	SurvivalMemory::TrackDestroyed(this, SurvivalMemory::ECategory::Pickups);
+
+	Super::BeginDestroy();
+}
+
+// Called when the game starts or when spawned
+void APickup::BeginPlay()
+{
+	Super::BeginPlay();
+
+	//pickups placed in the level build their item from the template
+	if (HasAuthority() && ItemTemplate && bNetStartup)
+	{
+		InitializePickup(ItemTemplate->GetClass(), ItemTemplate->GetQuantity());
+	}
+
+	//pickups that were spawned at runtime, i.e. dropped, need to line up with whatever is below them
+	if (!bNetStartup)
+	{
+		AlignWithGround();
+
+		if (HasAuthority() && DespawnTime > 0.f && !bIgnoreDespawnTime)
+		{
+			if (UItemLifecycleComponent* ItemLifecycle = UItemLifecycleComponent::Get(this))
+			{
+				ItemLifecycle->ScheduleDespawn(this, DespawnTime);
+			}
+		}
+	}
+
+	if (Item)
+	{
+		Item->MarkDirtyForReplication();
+	}
+}
+
+void APickup::GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(APickup, Item);
+}
+
+bool APickup::ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags)
+{
+	bool bWroteSomething = Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
+
+	//only send the item if its repkey changed since we last sent it
+	if (Item && Channel->KeyNeedsToReplicate(Item->GetUniqueID(), Item->RepKey))
+	{
+		bWroteSomething |= Channel->ReplicateSubobject(Item, *Bunch, *RepFlags);
+	}
+
+	return bWroteSomething;
+}
+
+#if WITH_EDITOR
+void APickup::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	FName PropertyName = (PropertyChangedEvent.Property != NULL) ? PropertyChangedEvent.Property->GetFName() : NAME_None;
+
+	//if a new pickup is selected in the property editor, change the mesh to reflect the new item being selected
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(APickup, ItemTemplate))
+	{
+		if (ItemTemplate)
+		{
+			PickupMesh->SetStaticMesh(ItemTemplate->PickupMesh);
+		}
+	}
+}
+#endif
@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Pickup.generated.h"
+
+/**
+ * An item lying in the world. Holds a single replicated UItem and uses an interaction component so players can look at it.
+ */
+UCLASS(ClassGroup = (Items), Blueprintable, Abstract)
+class SURVIVALGAME_API APickup : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	APickup();
+
+	//Takes the item class and creates a pickup holding a new instance of it. NextDecayTime carries over the decay of an item that was already rotting
+	void InitializePickup(const TSubclassOf<class UItem> ItemClass, const int32 Quantity, const float NextDecayTime = 0.f);
+
+	//Align pickups with the ground when they are dropped. Done in blueprint
+	UFUNCTION(BlueprintImplementableEvent)
+	void AlignWithGround();
+
+	//How long in seconds a pickup spawned at runtime, e.g. dropped by a player, stays in the world. Zero means forever
+	UPROPERTY(EditDefaultsOnly, Category = "Pickup", meta = (ClampMin = 0.0))
+	float DespawnTime;
+
+	//Set before the pickup begins play by whatever looks after its lifetime itself, i.e. the loot spawner, so DespawnTime doesn't apply
+	bool bIgnoreDespawnTime;
+
+	//This is used as a template to create the pickup when spawned in the level
+	UPROPERTY(EditAnywhere, Instanced)
+	class UItem* ItemTemplate;
+
+	FORCEINLINE class UItem* GetItem() const { return Item; }
+
+	//[Server] Move as much of the item as fits into the inventory. Whatever doesn't fit stays on the ground, otherwise the pickup is destroyed
+	struct FItemAddResult TakePickup(class UInventoryComponent* Inventory);
+
+	//[Client] Hide the pickup while the local player's prediction that they took it is waiting on the server
+	void SetPredictedTaken(const bool bTaken);
+
+protected:
+
+	//The item that will be added to the inventory when this pickup is taken
+	UPROPERTY(ReplicatedUsing = OnRep_Item, BlueprintReadOnly, Category = "Pickup")
+	class UItem* Item;
+
+	UFUNCTION()
+	void OnRep_Item();
+
+	//If some property on the item is modified, we bind this to OnItemModified and refresh the UI if the item gets modified
+	UFUNCTION()
+	void OnItemModified();
+
+	//[Server] Called when a player takes the pickup. Adds as much of the item as fits into their inventory
+	UFUNCTION()
+	void OnTakePickup(class ASurvivalCharacter* Taker);
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual bool ReplicateSubobjects(class UActorChannel* Channel, class FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
+
+	//Counted for Survival.MemReport
+	virtual void PostInitProperties() override;
+	virtual void BeginDestroy() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+public:
+
+	UPROPERTY(EditAnywhere, Category = "Components")
+	class UStaticMeshComponent* PickupMesh;
+
+	UPROPERTY(EditAnywhere, Category = "Components")
+	class UInteractionComponent* InteractionComponent;
+
+};
@@ -0,0 +1,14 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+public class SurvivalGameServerTarget : TargetRules
+{
+	public SurvivalGameServerTarget(TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Server;
+
+		ExtraModuleNames.AddRange( new string[] { "SurvivalGame" } );
+	}
+}